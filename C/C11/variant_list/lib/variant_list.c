@@ -74,6 +74,23 @@ int main (int argc, char *argv[])
       putchar('\n');
     }
 
+    { double f, sum = 0.0;
+      ListIter* it = list_iter_begin(l); // one lock for the whole scan
+      while (list_iter_next(it)) {
+        list_iter_get(it, &f);
+        sum += f;
+      }
+      list_iter_end(it);
+      printf("(Sum of all elements fetched as Floats: %f)\n\n", sum);
+    }
+
+    { char buf[32];
+      list_add_string(l, NULL); // legal, fetched as ""
+      list_get_string_buf(l, list_length(l)-1, buf, sizeof(buf));
+      printf("(Last element, a NULL string, fetched into a buffer: '%s')\n\n", buf);
+      list_del_last(l);
+    }
+
     printf("(Deleting 3rd element now)\n\n");
     list_del(l, 2);
     list_dump(l);
@@ -25,7 +25,10 @@ extern "C" {
 #endif
 
 #include <stdbool.h>      // for "bool","_Bool"
+#include <stddef.h>       // for "size_t"
+#include <stdint.h>       // for "int64_t"
 #include <errno.h>        // for "errno","errno_t"-C11
+#include <limits.h>       // for "INT_MAX","LONG_MAX"
 
 
 // PLUMBERY
@@ -33,12 +36,12 @@ extern "C" {
 #ifndef _ERRCODE_DEFINED
   typedef int errno_t;   // C11 (but only MinGW provides it now)
 #else
-#  include <limits.h>
   _Static_assert( INT_MAX == ((errno_t)0)+INT_MAX, "errno_t invalid"); // C11
 #endif
 
  // required so that "true/false" get recognized as "bool" by C11's _Generic
-#if __STDC_VERSION__ < 202311L
+ // (C++ has no "_Bool", nor "_Generic": see "variant_list.hpp")
+#if !defined(__cplusplus) && __STDC_VERSION__ < 202311L
 #  undef  true
 #  undef  false
 #  define true  ((_Bool)+1)
@@ -49,65 +52,413 @@ extern "C" {
 // TYPES
 
 typedef struct List List;
+typedef struct ListIter ListIter;
+typedef struct ListValue ListValue;
 
 #define EUNDEF   200
 #define EINTEGER (EUNDEF + 1)
 #define EBOOLEAN (EUNDEF + 2)
 #define EFLOAT   (EUNDEF + 3)
 #define ESTRING  (EUNDEF + 4)
+#define EINT64   (EUNDEF + 5)
+#define EBLOB    (EUNDEF + 6)
+
+ // bytes the list keeps its own copy of (up to 7 inline, longer ones in an
+ // arena that goes with the list, and its snapshots); getting one points to
+ // that copy, valid until the list changes. Blobs convert to no number (0),
+ // and to strings up to their first NUL; strings get as blobs of their text
+typedef struct
+{
+    const void* data;
+    size_t size;          // up to 4 GiB
+} ListBlob;
+
+ // "list_create_flags()" options
+#define LIST_DEFAULT   0x00
+#define LIST_STRCACHE  0x01  // keep the text of converted values for next gets
+#define LIST_COMPACT   0x02  /* packed arrays, ~9 bytes per value; strings
+                                under 8 bytes are copied inline, so pointers
+                                to them only last until the list changes
+                                (pops return copies, see below) */
+#define LIST_HASHINDEX 0x04  // value -> position index, for "list_find()"
+#define LIST_SHARDED   0x08  /* appends from many threads go to per-thread
+                                buffers, merged in batches (and before any
+                                other call): each thread's values keep their
+                                order, threads interleave by merge order */
 
 
 // PUBLIC FUNCTION PROTOTYPES
 
 List* list_create(unsigned int timeout);
+List* list_create_flags(unsigned int timeout, unsigned int flags);
 
 errno_t list_add_int(List* list, int i);
 errno_t list_add_bool(List* list, bool b);
 errno_t list_add_float(List* list, double f);
 errno_t list_add_string(List* list, char* s);
+errno_t list_add_int64(List* list, int64_t l);
+errno_t list_add_blob(List* list, ListBlob b);
 
 errno_t list_insert_int(List* list, size_t idx, int i);
 errno_t list_insert_bool(List* list, size_t idx, bool b);
 errno_t list_insert_float(List* list, size_t idx, double f);
 errno_t list_insert_string(List* list, size_t idx, char* s);
+errno_t list_insert_int64(List* list, size_t idx, int64_t l);
+errno_t list_insert_blob(List* list, size_t idx, ListBlob b);
 
 errno_t list_get_int(List* list, size_t idx, int* i);
 errno_t list_get_bool(List* list, size_t idx, bool* b);
 errno_t list_get_float(List* list, size_t idx, double* f);
 errno_t list_get_string(List* list, size_t idx, char** s);
+errno_t list_get_int64(List* list, size_t idx, int64_t* l);
+errno_t list_get_blob(List* list, size_t idx, ListBlob* b);
 errno_t list_get_Type(List* list, size_t idx, void* n);
 
+ // no allocation: formats into "buf", ERANGE if truncated; a NULL string
+ // gives "". Unlike "list_get_string()" and its "%.6f", floats come out
+ // in the fewest digits that read back exactly ("0.1", "5e-324", laid out
+ // as "%g" does), so the two may differ for the same double
+errno_t list_get_string_buf(List* list, size_t idx, char* buf, size_t len);
+
 // C11: these generic macros will make our life easier
 
+ // "long" and "long long" go with int64_t: it is one of them, so only the
+ // other one reaches this "default"; pointers to it get read through an
+ // int64_t (see the end), "long*" only where it has 64 bits. Other types
+ // still fail to compile, with nothing to call
+#if LONG_MAX == INT64_MAX
+#  define _LIST_LONG_PTR(F) long*: F##_long,
+#else
+#  define _LIST_LONG_PTR(F)
+#endif
+#define _LIST_INT64_OR(V, F)     _Generic((V), long: F, long long: F, default: 0)
+#define _LIST_INT64_PTR_OR(V, F) _Generic((V), _LIST_LONG_PTR(F) long long*: F##_llong, default: 0)
+
 #define list_add(L, V) _Generic((V), \
-    int:    list_add_int, \
-    bool:   list_add_bool, \
-    double: list_add_float, \
-    char*:  list_add_string)(L, V)
+    int:      list_add_int, \
+    bool:     list_add_bool, \
+    double:   list_add_float, \
+    char*:    list_add_string, \
+    int64_t:  list_add_int64, \
+    ListBlob: list_add_blob, \
+    default:  _LIST_INT64_OR(V, list_add_int64))(L, V)
 
 #define list_insert(L, I, V) _Generic((V), \
-    int:    list_insert_int, \
-    bool:   list_insert_bool, \
-    double: list_insert_float, \
-    char*:  list_insert_string)(L, I, V)
+    int:      list_insert_int, \
+    bool:     list_insert_bool, \
+    double:   list_insert_float, \
+    char*:    list_insert_string, \
+    int64_t:  list_insert_int64, \
+    ListBlob: list_insert_blob, \
+    default:  _LIST_INT64_OR(V, list_insert_int64))(L, I, V)
 
 #define list_get(L, I, V) _Generic((V), \
-    int*:    list_get_int, \
-    bool*:   list_get_bool, \
-    double*: list_get_float, \
-    char**:  list_get_string, \
-    void*:   list_get_Type)(L, I, V)
+    int*:      list_get_int, \
+    bool*:     list_get_bool, \
+    double*:   list_get_float, \
+    char**:    list_get_string, \
+    int64_t*:  list_get_int64, \
+    ListBlob*: list_get_blob, \
+    void*:     list_get_Type, \
+    default:   _LIST_INT64_PTR_OR(V, list_get))(L, I, V)
+
+// bulk: one lock (and no re-walk) per call, whatever the count; the
+// range getters return the first conversion code met, like "list_get"
+
+errno_t list_add_ints(List* list, const int* a, size_t n);
+errno_t list_add_floats(List* list, const double* a, size_t n);
+errno_t list_append_list(List* list, List* other); // same storage only,
+                                                   // moves, empties "other"
+                                                   // (EAGAIN: moves nothing)
+
+errno_t list_get_ints(List* list, size_t idx, size_t n, int* a);
+errno_t list_get_bools(List* list, size_t idx, size_t n, bool* a);
+errno_t list_get_floats(List* list, size_t idx, size_t n, double* a);
+
+#define list_get_range(L, I, N, A) _Generic((A), \
+    int*:    list_get_ints, \
+    bool*:   list_get_bools, \
+    double*: list_get_floats)(L, I, N, A)
+
+// aggregates: one lock and one pass over packed per-type columns, SIMD
+// where the CPU allows; mismatching values are converted like "list_get"
+// does, and the first conversion code met is returned
+
+errno_t list_sum_float(List* list, double* sum);
+errno_t list_minmax_int(List* list, int* min, int* max);
+errno_t list_count_type(List* list, errno_t type, size_t* count); // EINTEGER...
+
+// lookup: first position holding an equal value of the same type, ENOENT
+// if none; O(1) expected with LIST_HASHINDEX, a scan otherwise
+
+errno_t list_find_int(List* list, int i, size_t* idx);
+errno_t list_find_bool(List* list, bool b, size_t* idx);
+errno_t list_find_float(List* list, double f, size_t* idx);
+errno_t list_find_string(List* list, const char* s, size_t* idx);
+errno_t list_find_int64(List* list, int64_t l, size_t* idx);
+errno_t list_find_blob(List* list, ListBlob b, size_t* idx);
+
+#define list_find(L, V, I) _Generic((V), \
+    int:      list_find_int, \
+    bool:     list_find_bool, \
+    double:   list_find_float, \
+    char*:    list_find_string, \
+    int64_t:  list_find_int64, \
+    ListBlob: list_find_blob, \
+    default:  _LIST_INT64_OR(V, list_find_int64))(L, V, I)
+
+// sorting: one lock, in parallel on large lists; "cmp" NULL means
+// "list_compare()", the built-in total order: by type first (int and
+// int64 as one < bool < float < string < blob), then by value (NaN last,
+// NULL strings first, blobs bytewise with shorter ones first)
+
+typedef int (*ListCompare)(const ListValue* a, const ListValue* b);
+
+errno_t list_sort(List* list, ListCompare cmp);
+errno_t list_sort_stable(List* list, ListCompare cmp); // equal ones keep order
+int list_compare(const ListValue* a, const ListValue* b);
+
+errno_t list_value_get_int(const ListValue* v, int* i);
+errno_t list_value_get_bool(const ListValue* v, bool* b);
+errno_t list_value_get_float(const ListValue* v, double* f);
+errno_t list_value_get_string(const ListValue* v, char** s);
+errno_t list_value_get_int64(const ListValue* v, int64_t* l);
+errno_t list_value_get_blob(const ListValue* v, ListBlob* b);
+errno_t list_value_get_Type(const ListValue* v, void* n);
+
+#define list_value_get(LV, V) _Generic((V), \
+    int*:      list_value_get_int, \
+    bool*:     list_value_get_bool, \
+    double*:   list_value_get_float, \
+    char**:    list_value_get_string, \
+    int64_t*:  list_value_get_int64, \
+    ListBlob*: list_value_get_blob, \
+    void*:     list_value_get_Type, \
+    default:   _LIST_INT64_PTR_OR(V, list_value_get))(LV, V)
+
+// parallel: "fn" runs on every value, on contiguous ranges spread over the
+// worker pool sorting uses (serially under 16K values), with the list
+// locked; being concurrent, it must only touch its value (changing it with
+// "list_value_set") and thread-safe state in "ctx". Reducing folds each
+// range into its own copy of "acc" ("size" bytes, that must start as the
+// identity: 0 for a sum...), then "combine()"s those into "acc", in order
+
+typedef void (*ListForeach)(ListValue* v, size_t idx, void* ctx);
+typedef void (*ListReduce)(void* acc, const ListValue* v, void* ctx);
+typedef void (*ListCombine)(void* acc, const void* other, void* ctx);
+
+errno_t list_foreach_parallel(List* list, ListForeach fn, void* ctx);
+errno_t list_reduce_parallel(List* list, ListReduce fn, ListCombine combine,
+                             void* acc, size_t size, void* ctx);
+
+// numbers: strings holding one (spaces around it allowed; no hex, "inf" or
+// "nan") become ints, int64s past INT_MAX or floats, in parallel the same
+// way; other strings stay. String getters parse like this, in the "C"
+// locale whatever "setlocale()" says, digits 8 at a time
+errno_t list_parse_numeric(List* list);
+
+errno_t list_value_set_int(ListValue* v, int i);
+errno_t list_value_set_bool(ListValue* v, bool b);
+errno_t list_value_set_float(ListValue* v, double f);
+errno_t list_value_set_string(ListValue* v, char* s);
+errno_t list_value_set_int64(ListValue* v, int64_t l);
+
+ // (no blobs: copying them takes the list)
+#define list_value_set(LV, V) _Generic((V), \
+    int:     list_value_set_int, \
+    bool:    list_value_set_bool, \
+    double:  list_value_set_float, \
+    char*:   list_value_set_string, \
+    int64_t: list_value_set_int64, \
+    default: _LIST_INT64_OR(V, list_value_set_int64))(LV, V)
+
+// persistence: a little-endian binary file (header, type tags, 8-byte
+// payloads, string heap); "list_map()" gives a read-only LIST_COMPACT list
+// that uses the file in place: nothing gets parsed, pages load on access,
+// and changes fail with EROFS
+
+errno_t list_save(List* list, const char* path);
+List* list_map(const char* path);
+
+// snapshot: a read-only LIST_COMPACT list (changes fail with EROFS) holding
+// the values as they are now, for long reads (scans, dumps, saves) that
+// would otherwise lock the list out; "list_destroy()" it when done.
+// LIST_COMPACT lists share their arrays with it, and copy them only before
+// overwriting values it holds (adding or popping at the ends does not);
+// linked ones get copied, in one walk. Strings and blobs are shared, not
+// copied (blobs stay valid as long as a snapshot does)
+List* list_snapshot(List* list);
+
+// journal: every change is appended to "path" as it happens (fsync'ed
+// every "sync_every" changes, 0 for only on "list_sync()" and destroy);
+// "list_checkpoint()" (also run when the journal outgrows the list, and
+// after sorting) saves "<path>.snap" and starts the journal over; opening
+// loads the snapshot then replays the journal, up to its first torn record
+
+List* list_open_journal(const char* path, unsigned int timeout, unsigned int flags,
+                        unsigned int sync_every);
+errno_t list_sync(List* list);
+errno_t list_checkpoint(List* list);
+
+// queue: a bounded FIFO for producer and consumer threads, lock-free: adds
+// push at the back, "list_pop_front()" and "list_del_first()" take from
+// the front; when full or empty, they wait up to "timeout" microseconds,
+// then fail with EAGAIN. It has no positions (other calls see it empty),
+// its length is a snapshot, and it only takes blobs up to 7 bytes (EINVAL)
+
+List* list_create_queue(unsigned int timeout, size_t capacity);
+
+// shared: a LIST_COMPACT list in named shared memory, for processes to
+// exchange values without pipes or copies; the first one to use "name"
+// creates it for "capacity" values (and ~32 bytes of strings per value),
+// others attach to it (any "capacity", 0 to fail with ENOENT if it does not
+// exist yet). Adds append lock-free from any process, then fail with ENOMEM
+// once full; other changes fail with EROFS. Values get visible to all once
+// those added before them are; the memory goes with the last list on it.
+// A process dying in the middle of an add leaves a value of no type there
+// (EUNDEF), once a reader sees that its pid is gone (after it got reaped)
+List* list_create_shared(const char* name, size_t capacity);
 
 errno_t list_del(List* list, size_t idx);
 errno_t list_del_last(List* list);
 errno_t list_del_first(List* list);
 
+// pops: a get and a delete under one lock, EINVAL if empty; both ends are
+// O(1) (deletions and insertions only re-index values up to the nearest end)
+// LIST_COMPACT inline strings go with the value: a string pop hands them
+// out as a copy and ESTRING, to free like other converted text
+
+errno_t list_pop_front_int(List* list, int* i);
+errno_t list_pop_front_bool(List* list, bool* b);
+errno_t list_pop_front_float(List* list, double* f);
+errno_t list_pop_front_string(List* list, char** s);
+errno_t list_pop_front_int64(List* list, int64_t* l);
+errno_t list_pop_front_Type(List* list, void* n);
+
+errno_t list_pop_back_int(List* list, int* i);
+errno_t list_pop_back_bool(List* list, bool* b);
+errno_t list_pop_back_float(List* list, double* f);
+errno_t list_pop_back_string(List* list, char** s);
+errno_t list_pop_back_int64(List* list, int64_t* l);
+errno_t list_pop_back_Type(List* list, void* n);
+
+ // (no blobs: a popped one would have nowhere to live; get, then delete)
+#define list_pop_front(L, V) _Generic((V), \
+    int*:     list_pop_front_int, \
+    bool*:    list_pop_front_bool, \
+    double*:  list_pop_front_float, \
+    char**:   list_pop_front_string, \
+    int64_t*: list_pop_front_int64, \
+    void*:    list_pop_front_Type, \
+    default:  _LIST_INT64_PTR_OR(V, list_pop_front))(L, V)
+
+#define list_pop_back(L, V) _Generic((V), \
+    int*:     list_pop_back_int, \
+    bool*:    list_pop_back_bool, \
+    double*:  list_pop_back_float, \
+    char**:   list_pop_back_string, \
+    int64_t*: list_pop_back_int64, \
+    void*:    list_pop_back_Type, \
+    default:  _LIST_INT64_PTR_OR(V, list_pop_back))(L, V)
+
 errno_t list_destroy(List* list);
 
+// export: the values written to "fd" (file, pipe, socket...), formatted
+// into a 1 MiB buffer that goes out in big "write()"s, from a snapshot (the
+// list is locked only while taking it; queues and shared lists throughout)
+
+#define LIST_TEXT   0  // what "list_dump()" prints on stdout
+#define LIST_JSON   1  // [1,true,2.5,"text",{"blob":"<base64>"}], NaN as null
+#define LIST_CSV    2  // "type,value" lines, RFC 4180 quotes, blobs in hex
+#define LIST_BINARY 3  // a "list_save()" file, in one sequential stream
+
+errno_t list_write(List* list, int fd, unsigned int format);
+
 errno_t list_dump(List* list);
 
 size_t list_length(List* list);
 
+// waiting: "list_wait_length()" blocks until the list holds "min_len" values
+// or more (then EXIT_SUCCESS), or "timeout" microseconds pass (EAGAIN); the
+// change that makes it true wakes it (shared lists poll: other processes
+// cannot). Watches run after each change, in the thread making it and with
+// the list locked (they may read it; keep them short); queue and shared
+// lists take none (EINVAL). Neither costs changes anything while unused.
+// Waiting in a thread that has the list locked (from a watch, a compare
+// function, or while iterating it) fails with EDEADLK: nothing could change it
+
+typedef void (*ListWatch)(List* list, size_t length, void* data);
+
+errno_t list_wait_length(List* list, size_t min_len, unsigned int timeout);
+errno_t list_watch(List* list, ListWatch fn, void* data);
+errno_t list_unwatch(List* list, ListWatch fn, void* data);
+
+// stats: counters since creation, cheap enough to leave on in production
+// (an uncontended lock costs no more than before)
+
+typedef struct
+{
+    size_t locks;         // acquisitions, nested ones too
+    size_t contended;     // of them that had to wait
+    size_t timeouts;      // waits given up on (EAGAIN)
+    double wait_ms;       // total time spent waiting
+    size_t memory;        // bytes held by values, blobs and index (strings aside)
+} ListStats;
+
+errno_t list_stats(List* list, ListStats* stats);
+
+// cursor: the list stays locked from "begin" to "end", so a full scan
+// costs one lock and one walk (do not modify the list meanwhile!)
+
+ListIter* list_iter_begin(List* list);
+bool list_iter_next(ListIter* iter);
+size_t list_iter_index(ListIter* iter);
+
+errno_t list_iter_get_int(ListIter* iter, int* i);
+errno_t list_iter_get_bool(ListIter* iter, bool* b);
+errno_t list_iter_get_float(ListIter* iter, double* f);
+errno_t list_iter_get_string(ListIter* iter, char** s);
+errno_t list_iter_get_int64(ListIter* iter, int64_t* l);
+errno_t list_iter_get_blob(ListIter* iter, ListBlob* b);
+errno_t list_iter_get_Type(ListIter* iter, void* n);
+errno_t list_iter_get_string_buf(ListIter* iter, char* buf, size_t len);
+
+#define list_iter_get(IT, V) _Generic((V), \
+    int*:      list_iter_get_int, \
+    bool*:     list_iter_get_bool, \
+    double*:   list_iter_get_float, \
+    char**:    list_iter_get_string, \
+    int64_t*:  list_iter_get_int64, \
+    ListBlob*: list_iter_get_blob, \
+    void*:     list_iter_get_Type, \
+    default:   _LIST_INT64_PTR_OR(V, list_iter_get))(IT, V)
+
+errno_t list_iter_end(ListIter* iter);
+
+ // the "long long*" and "long*" readers of the generic macros above
+#ifndef __cplusplus
+#  define _LIST_INT64_READ(CALL, V)                             \
+    int64_t l = 0;                                              \
+    errno_t e = CALL;                                           \
+    if (e == 0 || (e > EUNDEF && e <= EBLOB)) { *(V) = l; }     \
+    return e;
+#  define _LIST_INT64_READERS(T, S)                                                        \
+    static inline errno_t list_get_##S(List* list, size_t idx, T* v) {                     \
+        _LIST_INT64_READ(list_get_int64(list, idx, &l), v) }                               \
+    static inline errno_t list_value_get_##S(const ListValue* lv, T* v) {                  \
+        _LIST_INT64_READ(list_value_get_int64(lv, &l), v) }                                \
+    static inline errno_t list_pop_front_##S(List* list, T* v) {                           \
+        _LIST_INT64_READ(list_pop_front_int64(list, &l), v) }                              \
+    static inline errno_t list_pop_back_##S(List* list, T* v) {                            \
+        _LIST_INT64_READ(list_pop_back_int64(list, &l), v) }                               \
+    static inline errno_t list_iter_get_##S(ListIter* iter, T* v) {                        \
+        _LIST_INT64_READ(list_iter_get_int64(iter, &l), v) }
+_LIST_INT64_READERS(long long, llong)
+#  if LONG_MAX == INT64_MAX
+_LIST_INT64_READERS(long, long)
+#  endif
+#endif
+
 
 #ifdef  __cplusplus
 }
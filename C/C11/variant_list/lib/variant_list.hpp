@@ -0,0 +1,366 @@
+/*
+* variant_list.hpp [library header, C++17 wrapper]
+* Copyright (C) 2024  Manuel Bachmann <tarnyko.tarnyko.net>
+*
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 3.0 of the License, or (at your option) any later version.
+*
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library; if not, write to the
+* Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+* Boston, MA  02110-1301, USA.
+*/
+
+#pragma once
+
+#include <cstddef>        // for "std::size_t","std::ptrdiff_t"
+#include <cstdint>        // for "std::int64_t"
+#include <cstdlib>        // for "std::free()"
+#include <iterator>       // for "std::random_access_iterator_tag"
+#include <optional>       // for "std::optional"-C++17
+#include <string>         // for "std::string"
+#include <system_error>   // for "std::system_error"
+#include <type_traits>    // for "std::is_same_v"-C++17
+#include <utility>        // for "std::exchange()"
+#include <variant>        // for "std::variant"-C++17
+
+#include "variant_list.h"
+
+
+namespace variant_list {
+
+// TYPES
+
+ // a value of any type, its index being the "list_get_Type()" code minus
+ // EUNDEF (strings and blobs point into the list, as in C)
+using Value = std::variant<std::monostate, int, bool, double, const char*,
+                           std::int64_t, ListBlob>;
+
+ // failures throw this, with the library's errno code
+using Error = std::system_error;
+
+ // typed access, picked at compile time: one direct call into the library,
+ // no tag check on this side (other types fail to compile)
+template <typename T> struct Type;
+
+#define VARIANT_LIST_TYPE(T, NAME, CODE)                                              \
+    template <> struct Type<T>                                                        \
+    {                                                                                 \
+        static constexpr errno_t code = CODE;                                         \
+        static errno_t add(::List* l, T v)                 { return list_add_##NAME(l, v); } \
+        static errno_t insert(::List* l, std::size_t i, T v) { return list_insert_##NAME(l, i, v); } \
+        static errno_t get(::List* l, std::size_t i, T* v) { return list_get_##NAME(l, i, v); } \
+        static errno_t find(::List* l, T v, std::size_t* i) { return list_find_##NAME(l, v, i); } \
+        static errno_t value_get(const ListValue* lv, T* v) { return list_value_get_##NAME(lv, v); } \
+        static errno_t iter_get(ListIter* it, T* v)        { return list_iter_get_##NAME(it, v); } \
+    };
+
+VARIANT_LIST_TYPE(int,          int,   EINTEGER)
+VARIANT_LIST_TYPE(bool,         bool,  EBOOLEAN)
+VARIANT_LIST_TYPE(double,       float, EFLOAT)
+VARIANT_LIST_TYPE(std::int64_t, int64, EINT64)
+VARIANT_LIST_TYPE(ListBlob,     blob,  EBLOB)
+
+#undef VARIANT_LIST_TYPE
+
+ // strings are borrowed, never written to: the library only lacks "const"
+template <> struct Type<const char*>
+{
+    static constexpr errno_t code = ESTRING;
+    static errno_t add(::List* l, const char* v) { return list_add_string(l, const_cast<char*>(v)); }
+    static errno_t insert(::List* l, std::size_t i, const char* v) {
+        return list_insert_string(l, i, const_cast<char*>(v)); }
+    static errno_t get(::List* l, std::size_t i, const char** v) {
+        return converted(list_get_string(l, i, const_cast<char**>(v)), v); }
+    static errno_t find(::List* l, const char* v, std::size_t* i) {
+        return list_find_string(l, const_cast<char*>(v), i); }
+    static errno_t value_get(const ListValue* lv, const char** v) {
+        return converted(list_value_get_string(lv, const_cast<char**>(v)), v); }
+    static errno_t iter_get(ListIter* it, const char** v) {
+        return converted(list_iter_get_string(it, const_cast<char**>(v)), v); }
+
+    // other types come as new text, that nobody would free: "nullptr"
+    // instead ("std::string" gets them as text)
+    static errno_t converted(errno_t e, const char** v) {
+        if (e >= EINTEGER && e <= EBLOB) {
+          std::free(const_cast<char*>(*v));
+          *v = nullptr; }
+        return e; }
+};
+
+ // conversion codes are not failures, EUNDEF and errno values are
+inline errno_t check(errno_t e)
+{
+    if (e != EXIT_SUCCESS && (e < EINTEGER || e > EBLOB)) {
+        throw Error(e, std::generic_category()); }
+    return e;
+}
+
+template <typename T>
+T get(::List* l, std::size_t idx)
+{
+    if constexpr (std::is_same_v<T, std::string>) {
+      // no allocation on the library side: formatted into our buffer
+      std::string s(32, '\0');
+      errno_t e;
+      while ((e = list_get_string_buf(l, idx, s.data(), s.size())) == ERANGE) {
+        s.resize(s.size() * 4); }
+      check(e);
+      s.resize(std::char_traits<char>::length(s.data()));
+      return s;
+    } else {
+      T v{};
+      check(Type<T>::get(l, idx, &v));
+      return v;
+    }
+}
+
+inline Value at(::List* l, std::size_t idx)
+{
+    errno_t e = list_get_Type(l, idx, nullptr);
+    switch ((e == EUNDEF) ? e : check(e)) {
+      case EINTEGER: return Value(std::in_place_index<1>, get<int>(l, idx));
+      case EBOOLEAN: return Value(std::in_place_index<2>, get<bool>(l, idx));
+      case EFLOAT  : return Value(std::in_place_index<3>, get<double>(l, idx));
+      case ESTRING : return Value(std::in_place_index<4>, get<const char*>(l, idx));
+      case EINT64  : return Value(std::in_place_index<5>, get<std::int64_t>(l, idx));
+      case EBLOB   : return Value(std::in_place_index<6>, get<ListBlob>(l, idx));
+      default      : return Value();
+    }
+}
+
+
+// ITERATORS
+
+ // by position: "*it" is a "list_get()" (lock, seek, copy), so random steps
+ // are O(1) on LIST_COMPACT lists and snapshots, O(distance to the nearest
+ // end) on linked ones. Values come by value (a proxy: no "->", and no
+ // writing through it); "T" = "Value" reads whatever type is there
+template <typename T>
+class Iterator
+{
+  public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type        = T;
+    using difference_type   = std::ptrdiff_t;
+    using reference         = T;
+    using pointer           = void;
+
+    Iterator() = default;
+    Iterator(::List* l, std::size_t idx) : l_(l), idx_(idx) {}
+
+    T operator*() const {
+        if constexpr (std::is_same_v<T, Value>) { return variant_list::at(l_, idx_); }
+        else                                    { return variant_list::get<T>(l_, idx_); } }
+    T operator[](difference_type n) const { return *(*this + n); }
+
+    Iterator& operator++()    { ++idx_; return *this; }
+    Iterator& operator--()    { --idx_; return *this; }
+    Iterator  operator++(int) { Iterator it = *this; ++idx_; return it; }
+    Iterator  operator--(int) { Iterator it = *this; --idx_; return it; }
+    Iterator& operator+=(difference_type n) { idx_ += n; return *this; }
+    Iterator& operator-=(difference_type n) { idx_ -= n; return *this; }
+
+    friend Iterator operator+(Iterator it, difference_type n) { return it += n; }
+    friend Iterator operator+(difference_type n, Iterator it) { return it += n; }
+    friend Iterator operator-(Iterator it, difference_type n) { return it -= n; }
+    friend difference_type operator-(const Iterator& a, const Iterator& b) {
+        return static_cast<difference_type>(a.idx_ - b.idx_); }
+
+    friend bool operator==(const Iterator& a, const Iterator& b) { return a.idx_ == b.idx_; }
+    friend bool operator!=(const Iterator& a, const Iterator& b) { return a.idx_ != b.idx_; }
+    friend bool operator< (const Iterator& a, const Iterator& b) { return a.idx_ <  b.idx_; }
+    friend bool operator> (const Iterator& a, const Iterator& b) { return a.idx_ >  b.idx_; }
+    friend bool operator<=(const Iterator& a, const Iterator& b) { return a.idx_ <= b.idx_; }
+    friend bool operator>=(const Iterator& a, const Iterator& b) { return a.idx_ >= b.idx_; }
+
+  private:
+    ::List* l_ = nullptr;
+    std::size_t idx_ = 0;
+};
+
+template <typename T>
+struct Range
+{
+    Iterator<T> first, last;
+
+    Iterator<T> begin() const { return first; }
+    Iterator<T> end() const   { return last; }
+};
+
+
+// VALUES (as "list_foreach/reduce_parallel()" hand them)
+
+class ValueRef       // "set()" only where not const: foreach, not reduce
+{
+  public:
+    explicit ValueRef(ListValue* v) : v_(v) {}
+
+    template <typename T> T get() const {
+        T v{};
+        check(Type<T>::value_get(v_, &v));
+        return v; }
+    template <typename T> bool is() const {
+        return list_value_get_Type(v_, nullptr) == Type<T>::code; }
+
+    void set(int i)          { check(list_value_set_int(v_, i)); }
+    void set(bool b)         { check(list_value_set_bool(v_, b)); }
+    void set(double f)       { check(list_value_set_float(v_, f)); }
+    void set(const char* s)  { check(list_value_set_string(v_, const_cast<char*>(s))); }
+    void set(std::int64_t l) { check(list_value_set_int64(v_, l)); }
+
+  private:
+    ListValue* v_;
+};
+
+
+// LIST
+
+ // owns a "List*": destroyed with it, moved but never copied (a copy would
+ // be a deep one; "snapshot()" is the cheap read-only kind). Failures throw
+ // "Error"; conversions do not (like "list_get()", a double gets ints...)
+class List
+{
+  public:
+    explicit List(unsigned int flags = LIST_DEFAULT, unsigned int timeout = 0)
+        : List(Adopt{}, list_create_flags(timeout, flags)) {}
+
+    static List journal(const char* path, unsigned int flags = LIST_DEFAULT,
+                        unsigned int sync_every = 0, unsigned int timeout = 0) {
+        return adopt(list_open_journal(path, timeout, flags, sync_every)); }
+    static List queue(std::size_t capacity, unsigned int timeout = 0) {
+        return adopt(list_create_queue(timeout, capacity)); }
+    static List shared(const char* name, std::size_t capacity) {
+        return adopt(list_create_shared(name, capacity)); }
+    static List map(const char* path) {
+        return adopt(list_map(path)); }
+
+     // takes ownership of what the C API gave (NULL: throws its errno)
+    static List adopt(::List* l) { return List(Adopt{}, l); }
+
+    List(const List&) = delete;
+    List& operator=(const List&) = delete;
+    List(List&& o) noexcept : l_(std::exchange(o.l_, nullptr)) {}
+    List& operator=(List&& o) noexcept {
+        if (this != &o) {
+          if (l_) { list_destroy(l_); }
+          l_ = std::exchange(o.l_, nullptr); }
+        return *this; }
+    ~List() {
+        if (l_) { list_destroy(l_); } }
+
+    ::List* c_list() const noexcept { return l_; }
+    ::List* release() noexcept      { return std::exchange(l_, nullptr); }
+
+    std::size_t size() const { return list_length(l_); }
+    bool empty() const       { return size() == 0; }
+
+    template <typename T> void add(T v)                      { check(Type<T>::add(l_, v)); }
+    template <typename T> void insert(std::size_t idx, T v)  { check(Type<T>::insert(l_, idx, v)); }
+
+     // converted like "list_get()" (T = "std::string" for any as text)
+    template <typename T> T get(std::size_t idx) const { return variant_list::get<T>(l_, idx); }
+    Value at(std::size_t idx) const                    { return variant_list::at(l_, idx); }
+    Value operator[](std::size_t idx) const            { return at(idx); }
+
+    template <typename T>
+    std::optional<std::size_t> find(T v) const {
+        std::size_t idx;
+        errno_t e = Type<T>::find(l_, v, &idx);
+        if (e == ENOENT) {
+            return std::nullopt; }
+        check(e);
+        return idx; }
+
+     // empty (or a queue timing out): nothing; no blobs, as in C; strings
+     // as "std::string" (a LIST_COMPACT pop may only have a copy to give)
+    template <typename T> std::optional<T> pop_front() { return pop<T>(true); }
+    template <typename T> std::optional<T> pop_back()  { return pop<T>(false); }
+
+    void del(std::size_t idx) { check(list_del(l_, idx)); }
+    void del_first()          { check(list_del_first(l_)); }
+    void del_last()           { check(list_del_last(l_)); }
+
+    void sort(ListCompare cmp = nullptr)        { check(list_sort(l_, cmp)); }
+    void sort_stable(ListCompare cmp = nullptr) { check(list_sort_stable(l_, cmp)); }
+    void parse_numeric()                        { check(list_parse_numeric(l_)); }
+
+    List snapshot() const                 { return adopt(list_snapshot(l_)); }
+    void save(const char* path) const     { check(list_save(l_, path)); }
+    ListStats stats() const {
+        ListStats s;
+        check(list_stats(l_, &s));
+        return s; }
+
+     // "fn(ValueRef& v, std::size_t idx)" on every value, in parallel (so
+     // "fn" gets called from many threads at once)
+    template <typename F>
+    void for_each_parallel(F fn) {
+        auto call = [](ListValue* v, std::size_t idx, void* ctx) {
+            ValueRef ref(v);
+            (*static_cast<F*>(ctx))(ref, idx); };
+        check(list_foreach_parallel(l_, call, &fn)); }
+
+     // "fn(Acc& acc, const ValueRef& v)" folds ranges, "combine(Acc& acc,
+     // const Acc& other)" joins them in order; "init" must be the identity
+    template <typename Acc, typename F, typename C>
+    Acc reduce_parallel(Acc init, F fn, C combine) const {
+        static_assert(std::is_trivially_copyable_v<Acc>, "accumulators get copied bytewise");
+        struct Fns { F* fn; C* combine; } fns{ &fn, &combine };
+        auto fold = [](void* acc, const ListValue* v, void* ctx) {
+            const ValueRef ref(const_cast<ListValue*>(v));
+            (*static_cast<Fns*>(ctx)->fn)(*static_cast<Acc*>(acc), ref); };
+        auto join = [](void* acc, const void* other, void* ctx) {
+            (*static_cast<Fns*>(ctx)->combine)(*static_cast<Acc*>(acc), *static_cast<const Acc*>(other)); };
+        check(list_reduce_parallel(l_, fold, join, &init, sizeof(Acc), &fns));
+        return init; }
+
+     // any type ("Value"), or read as "T" without looking at the tag
+    Iterator<Value> begin() const { return Iterator<Value>(l_, 0); }
+    Iterator<Value> end() const   { return Iterator<Value>(l_, size()); }
+    template <typename T>
+    Range<T> as() const { return { Iterator<T>(l_, 0), Iterator<T>(l_, size()) }; }
+
+  private:
+    struct Adopt {};
+    List(Adopt, ::List* l) : l_(l) {
+        if (!l_) {
+            throw Error(errno, std::generic_category()); } }
+
+    template <typename T>
+    std::optional<T> pop(bool front) {
+        static_assert(!std::is_same_v<T, ListBlob>, "no blob pops: get, then delete");
+        static_assert(!std::is_same_v<T, const char*>, "string pops: pop<std::string>");
+        T v{};
+        errno_t e;
+        if constexpr (std::is_same_v<T, std::string>) {
+          char* s = nullptr;
+          e = front ? list_pop_front_string(l_, &s) : list_pop_back_string(l_, &s);
+          if (s) { v = s; }
+          if (e >= EINTEGER && e <= EBLOB) { std::free(s); }
+        } else if constexpr (std::is_same_v<T, int>) {
+          e = front ? list_pop_front_int(l_, &v) : list_pop_back_int(l_, &v);
+        } else if constexpr (std::is_same_v<T, bool>) {
+          e = front ? list_pop_front_bool(l_, &v) : list_pop_back_bool(l_, &v);
+        } else if constexpr (std::is_same_v<T, double>) {
+          e = front ? list_pop_front_float(l_, &v) : list_pop_back_float(l_, &v);
+        } else {
+          static_assert(std::is_same_v<T, std::int64_t>, "no such value type");
+          e = front ? list_pop_front_int64(l_, &v) : list_pop_back_int64(l_, &v);
+        }
+        if (e == EINVAL || e == EAGAIN) {
+            return std::nullopt; }
+        check(e);
+        return v; }
+
+    ::List* l_;
+};
+
+} // namespace variant_list
@@ -0,0 +1,541 @@
+/*
+* variant_list_bench.c [benchmark executable]
+* Copyright (C) 2024  Manuel Bachmann <tarnyko.tarnyko.net>
+*
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 3.0 of the License, or (at your option) any later version.
+*
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library; if not, write to the
+* Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+* Boston, MA  02110-1301, USA.
+*/
+
+#define _GNU_SOURCE
+#include <stdio.h>        // for "printf()"
+#include <stdlib.h>       // for "strtoul()","strtod()","qsort()"...
+#include <time.h>         // for "timespec_get()"-C11
+#include "_threads.h"     // for "thrd_create()"-C11
+#ifdef __GLIBC__
+#  include <malloc.h>     // for "mallinfo2()"
+#endif
+
+#include "variant_list.h"
+
+#ifdef _WIN32
+#  define NULL_DEVICE "NUL"
+#else
+#  define NULL_DEVICE "/dev/null"
+#endif
+
+
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 33)
+#  define HEAP_USED() mallinfo2().uordblks
+#else
+#  define HEAP_USED() 0   // bytes per value not measurable here
+#endif
+
+static double now_ms(void)
+{
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+static void bench_storage(const char* name, unsigned int flags, size_t n)
+{
+    size_t heap = HEAP_USED();
+    List* l = list_create_flags(0, flags);
+
+    // mixed content, as real lists hold
+    double t0 = now_ms();
+    for (size_t i = 0; i < n; i++) {
+      switch (i % 4) {
+        case 0: list_add(l, (int)i);       break;
+        case 1: list_add(l, (double)i);    break;
+        case 2: list_add(l, (i % 8 == 2)); break;
+        case 3: list_add(l, "value");      break;
+      }
+    }
+    double t1 = now_ms();
+    size_t used = HEAP_USED() - heap;
+
+    double f, sum = 0.0;
+    ListIter* it = list_iter_begin(l);
+    while (list_iter_next(it)) {
+      if (list_iter_get(it, &f) == EXIT_SUCCESS) {
+        sum += f; }
+    }
+    list_iter_end(it);
+    double t2 = now_ms();
+
+    printf("%-10s %10zu %12.1f %12.2f %12.2f   (%g)\n", name, n,
+           (double)used / n, t1 - t0, t2 - t1, sum);
+
+    list_destroy(l);
+}
+
+static size_t next_rand(size_t* x)   // xorshift: "rand()" is not thread-safe
+{
+    *x ^= *x << 13;
+    *x ^= *x >> 7;
+    *x ^= *x << 17;
+    return *x;
+}
+
+static void bench_ops(const char* name, unsigned int flags, size_t n)
+{
+    size_t ops = (n > 1000000) ? 100 : 1000;   // single ones, at random places
+    size_t x = 42;
+    int v;
+    List* l = list_create_flags(0, flags);
+
+    double t0 = now_ms();
+    for (size_t i = 0; i < n; i++) {
+      list_add(l, (int)i); }
+    double t1 = now_ms();
+    for (size_t k = 0; k < ops; k++) {
+      list_insert(l, list_length(l) / 2, (int)k); }
+    double t2 = now_ms();
+    for (size_t k = 0; k < ops; k++) {
+      list_get(l, next_rand(&x) % n, &v); }
+    double t3 = now_ms();
+    ListIter* it = list_iter_begin(l);
+    while (list_iter_next(it)) {
+      list_iter_get(it, &v); }
+    list_iter_end(it);
+    double t4 = now_ms();
+    for (size_t k = 0; k < ops; k++) {
+      list_del_first(l); }
+    double t5 = now_ms();
+    for (size_t k = 0; k < ops; k++) {
+      list_del_last(l); }
+    double t6 = now_ms();
+
+    // all in ns per value or operation
+    printf("%-10s %10zu %9.1f %9.1f %9.1f %9.1f %9.1f %9.1f\n", name, n,
+           (t1 - t0) * 1e6 / n, (t2 - t1) * 1e6 / ops, (t3 - t2) * 1e6 / ops,
+           (t4 - t3) * 1e6 / n, (t5 - t4) * 1e6 / ops, (t6 - t5) * 1e6 / ops);
+
+    list_destroy(l);
+}
+
+static int compare_ints(const void* a, const void* b)
+{
+    int x = *(const int*)a, y = *(const int*)b;
+    return (x > y) - (x < y);
+}
+
+static void bench_sort(const char* name, unsigned int flags, size_t n)
+{
+    int* a = (int*) malloc(n * sizeof(int));
+    srand(42);
+    for (size_t i = 0; i < n; i++) {
+      a[i] = rand(); }
+
+    List* l1 = list_create_flags(0, flags);
+    List* l2 = list_create_flags(0, flags);
+    List* l3 = list_create_flags(0, flags);
+    list_add_ints(l1, a, n);
+    list_add_ints(l2, a, n);
+    list_add_ints(l3, a, n);
+
+    // the old way: copy out, "qsort()", rebuild
+    double t0 = now_ms();
+    list_get_ints(l1, 0, n, a);
+    qsort(a, n, sizeof(int), compare_ints);
+    list_destroy(l1);
+    l1 = list_create_flags(0, flags);
+    list_add_ints(l1, a, n);
+    double t1 = now_ms();
+    list_sort(l2, NULL);
+    double t2 = now_ms();
+    list_sort_stable(l3, NULL);
+    double t3 = now_ms();
+
+    printf("%-10s %10zu %12.2f %12.2f %12.2f\n", name, n,
+           t1 - t0, t2 - t1, t3 - t2);
+
+    list_destroy(l1);
+    list_destroy(l2);
+    list_destroy(l3);
+    free(a);
+}
+
+static void bench_snapshot(const char* name, unsigned int flags, size_t n)
+{
+    List* l = list_create_flags(0, flags);
+    for (size_t i = 0; i < n; i++) {
+      list_add(l, (int)i); }
+
+    // how long writers are locked out: a whole scan, or taking a snapshot
+    int v;
+    double sum = 0.0;
+    double t0 = now_ms();
+    ListIter* it = list_iter_begin(l);
+    while (list_iter_next(it)) {
+      if (list_iter_get(it, &v) == EXIT_SUCCESS) {
+        sum += v; }
+    }
+    list_iter_end(it);
+    double t1 = now_ms();
+    List* snap = list_snapshot(l);
+    double t2 = now_ms();
+    list_add(l, 0);      // past the snapshot: no copy
+    list_del_first(l);
+    double t3 = now_ms();
+
+    printf("%-10s %10zu %12.2f %12.3f %12.3f   (%g)\n", name, n,
+           t1 - t0, t2 - t1, t3 - t2, sum);
+
+    list_destroy(snap);
+    list_destroy(l);
+}
+
+static void sum_value(void* acc, const ListValue* v, void* ctx)
+{
+    (void)ctx;
+    int i;
+    if (list_value_get_int(v, &i) == EXIT_SUCCESS) {
+      *(double*)acc += i; }
+}
+
+static void sum_combine(void* acc, const void* other, void* ctx)
+{
+    (void)ctx;
+    *(double*)acc += *(const double*)other;
+}
+
+static void double_value(ListValue* v, size_t idx, void* ctx)
+{
+    (void)idx; (void)ctx;
+    int i;
+    if (list_value_get_int(v, &i) == EXIT_SUCCESS) {
+      list_value_set(v, i * 2); }
+}
+
+static void bench_parallel(const char* name, unsigned int flags, size_t n)
+{
+    List* l = list_create_flags(0, flags);
+    for (size_t i = 0; i < n; i++) {
+      list_add(l, (int)i); }
+
+    // one thread walking an iterator, against the ranges run on the pool
+    int v;
+    double sum = 0.0, psum = 0.0;
+    double t0 = now_ms();
+    ListIter* it = list_iter_begin(l);
+    while (list_iter_next(it)) {
+      if (list_iter_get(it, &v) == EXIT_SUCCESS) {
+        sum += v; }
+    }
+    list_iter_end(it);
+    double t1 = now_ms();
+    list_reduce_parallel(l, sum_value, sum_combine, &psum, sizeof(psum), NULL);
+    double t2 = now_ms();
+    list_foreach_parallel(l, double_value, NULL);
+    double t3 = now_ms();
+
+    printf("%-10s %10zu %12.2f %12.2f %12.2f   (%s)\n", name, n,
+           t1 - t0, t2 - t1, t3 - t2, (sum == psum) ? "ok" : "MISMATCH");
+
+    list_destroy(l);
+}
+
+static void bench_parse(const char* name, unsigned int flags, size_t n)
+{
+    // CSV-like fields: a count, a price, one with an exponent
+    char* text = (char*) malloc(n * 24);
+    for (size_t i = 0; i < n; i++) {
+      switch (i % 3) {
+        case 0 : snprintf(&text[i * 24], 24, "%zu", i * 7919); break;
+        case 1 : snprintf(&text[i * 24], 24, "%zu.%02zu", i % 1000, i % 100); break;
+        default: snprintf(&text[i * 24], 24, "%zue-3", i); break;
+      }
+    }
+    List* l = list_create_flags(0, flags);
+    for (size_t i = 0; i < n; i++) {
+      list_add(l, &text[i * 24]); }
+
+    // "strtod()" on each string, getting them as floats, once parsed
+    double f, sum = 0.0, gsum = 0.0, psum = 0.0;
+    double t0 = now_ms();
+    for (size_t i = 0; i < n; i++) {
+      sum += strtod(&text[i * 24], NULL); }
+    double t1 = now_ms();
+    ListIter* it = list_iter_begin(l);
+    while (list_iter_next(it)) {
+      list_iter_get(it, &f);
+      gsum += f; }
+    list_iter_end(it);
+    double t2 = now_ms();
+    list_parse_numeric(l);
+    double t3 = now_ms();
+    it = list_iter_begin(l);
+    while (list_iter_next(it)) {
+      list_iter_get(it, &f);
+      psum += f; }
+    list_iter_end(it);
+    double t4 = now_ms();
+
+    printf("%-10s %10zu %12.2f %12.2f %12.2f %12.2f   (%s)\n", name, n,
+           t1 - t0, t2 - t1, t3 - t2, t4 - t3,
+           (sum == gsum && sum == psum) ? "ok" : "MISMATCH");
+
+    list_destroy(l);
+    free(text);
+}
+
+static void bench_write(const char* name, unsigned int flags, size_t n)
+{
+    List* l = list_create_flags(0, flags);
+    for (size_t i = 0; i < n; i++) {
+      switch (i % 3) {
+        case 0 : list_add(l, (int)i); break;
+        case 1 : list_add(l, i * 0.25); break;
+        default: list_add(l, "some text"); break;
+      }
+    }
+
+    // formatting and writing costs only, to the null device
+    FILE* f = fopen(NULL_DEVICE, "wb");
+    double t[LIST_BINARY + 2];
+    t[0] = now_ms();
+    for (unsigned int format = LIST_TEXT; format <= LIST_BINARY; format++) {
+      list_write(l, fileno(f), format);
+      t[format + 1] = now_ms();
+    }
+    fclose(f);
+
+    printf("%-10s %10zu %12.2f %12.2f %12.2f %12.2f\n", name, n,
+           t[1] - t[0], t[2] - t[1], t[3] - t[2], t[4] - t[3]);
+
+    list_destroy(l);
+}
+
+typedef struct
+{
+    List* list;
+    size_t n;
+} QueueJob;
+
+static int queue_producer(void* arg)
+{
+    QueueJob* job = (QueueJob*) arg;
+    for (size_t i = 0; i < job->n; i++) {
+      while (list_add(job->list, (int)i) != EXIT_SUCCESS) {} }
+    return 0;
+}
+
+static int queue_consumer(void* arg)
+{
+    QueueJob* job = (QueueJob*) arg;
+    int v;
+    for (size_t i = 0; i < job->n; ) {
+      if (list_pop_front(job->list, &v) == EXIT_SUCCESS) {
+        i++; }
+    }
+    return 0;
+}
+
+static void bench_queue(const char* name, bool queue, size_t pairs, size_t n)
+{
+    // or the old way: a list used as a queue, locked by each call
+    List* l = queue ? list_create_queue(1000, 4096) : list_create(1000);
+    QueueJob job = { l, n / pairs };
+    thrd_t thr[16];
+
+    double t0 = now_ms();
+    for (size_t t = 0; t < 2 * pairs; t++) {
+      thrd_create(&thr[t], (t % 2) ? queue_consumer : queue_producer, &job); }
+    for (size_t t = 0; t < 2 * pairs; t++) {
+      thrd_join(thr[t], NULL); }
+    double t1 = now_ms();
+
+    printf("%-10s %10zu %12zu %12.2f\n", name, n, 2 * pairs, t1 - t0);
+
+    list_destroy(l);
+}
+
+typedef struct
+{
+    List* list;
+    size_t n;
+    size_t seed;
+} MixedJob;
+
+static int mixed_worker(void* arg)
+{
+    MixedJob* job = (MixedJob*) arg;
+    int v;
+    for (size_t i = 0; i < job->n; i++) {
+      size_t r = next_rand(&job->seed);
+      switch (r % 10) {     // 80% reads, 20% writes at both ends
+        case 0: list_add(job->list, (int)i); break;
+        case 1: list_del_first(job->list);   break;
+        default: list_get(job->list, (r >> 8) % 1000, &v);
+      }
+    }
+    return 0;
+}
+
+static void bench_mixed(const char* name, unsigned int flags, size_t threads, size_t n)
+{
+    List* l = list_create_flags(100000, flags);
+    for (size_t i = 0; i < 1000 + n / 10; i++) {    // adds and deletes even out
+      list_add(l, (int)i); }
+    MixedJob jobs[64];
+    thrd_t thr[64];
+
+    double t0 = now_ms();
+    for (size_t t = 0; t < threads; t++) {
+      jobs[t] = (MixedJob){ l, n / threads, t + 1 };
+      thrd_create(&thr[t], mixed_worker, &jobs[t]); }
+    for (size_t t = 0; t < threads; t++) {
+      thrd_join(thr[t], NULL); }
+    double t1 = now_ms();
+
+    ListStats st;
+    list_stats(l, &st);
+    printf("%-10s %10zu %8zu %9.2f %9zu %9.2f %9.2f %9zu %9zu\n", name, n, threads,
+           t1 - t0, st.locks, 100.0 * st.contended / st.locks, st.wait_ms,
+           st.timeouts, st.memory / list_length(l));
+
+    list_destroy(l);
+}
+
+static int append_producer(void* arg)
+{
+    QueueJob* job = (QueueJob*) arg;
+    for (size_t i = 0; i < job->n; i++) {
+      list_add(job->list, (int)i); }
+    return 0;
+}
+
+static void bench_append(const char* name, unsigned int flags, size_t threads, size_t n)
+{
+    List* l = list_create_flags(100000, flags);
+    QueueJob job = { l, n / threads };
+    thrd_t thr[16];
+
+    double t0 = now_ms();
+    for (size_t t = 0; t < threads; t++) {
+      thrd_create(&thr[t], append_producer, &job); }
+    for (size_t t = 0; t < threads; t++) {
+      thrd_join(thr[t], NULL); }
+    size_t len = list_length(l);    // merges what is left
+    double t1 = now_ms();
+
+    printf("%-10s %10zu %12zu %12.2f\n", name, len, threads, t1 - t0);
+
+    list_destroy(l);
+}
+
+
+int main (int argc, char *argv[])
+{
+    size_t max = (argc > 1) ? strtoul(argv[1], NULL, 10) : 1000000;
+
+    printf("%-10s %10s %12s %12s %12s\n", "storage", "values",
+           "bytes/value", "append (ms)", "scan (ms)");
+    printf("-----------------------------------------------------------\n");
+
+    for (size_t n = 1000; n <= max; n *= 10) {
+      bench_storage("default", LIST_DEFAULT, n);
+      bench_storage("compact", LIST_COMPACT, n);
+    }
+
+    printf("\n%-10s %10s %9s %9s %9s %9s %9s %9s\n", "storage", "values",
+           "append", "insert", "get", "scan", "del 1st", "del last");
+    printf("---------------------------------------------------------------------------- (ns)\n");
+
+    for (size_t n = 1000; n <= max; n *= 10) {
+      bench_ops("default", LIST_DEFAULT, n);
+      bench_ops("compact", LIST_COMPACT, n);
+    }
+
+    printf("\n%-10s %10s %12s %12s %12s\n", "storage", "values",
+           "qsort (ms)", "sort (ms)", "stable (ms)");
+    printf("-----------------------------------------------------------\n");
+
+    for (size_t n = 1000; n <= max; n *= 10) {
+      bench_sort("default", LIST_DEFAULT, n);
+      bench_sort("compact", LIST_COMPACT, n);
+    }
+
+    printf("\n%-10s %10s %12s %12s %12s\n", "storage", "values",
+           "scan (ms)", "snap (ms)", "1st add (ms)");
+    printf("-----------------------------------------------------------\n");
+
+    for (size_t n = 1000; n <= max; n *= 10) {
+      bench_snapshot("default", LIST_DEFAULT, n);
+      bench_snapshot("compact", LIST_COMPACT, n);
+    }
+
+    printf("\n%-10s %10s %12s %12s %12s\n", "storage", "values",
+           "scan (ms)", "reduce (ms)", "foreach (ms)");
+    printf("-----------------------------------------------------------\n");
+
+    for (size_t n = 1000; n <= max; n *= 10) {
+      bench_parallel("default", LIST_DEFAULT, n);
+      bench_parallel("compact", LIST_COMPACT, n);
+    }
+
+    printf("\n%-10s %10s %12s %12s %12s %12s\n", "storage", "values",
+           "strtod (ms)", "get (ms)", "parse (ms)", "get (ms)");
+    printf("------------------------------------------------------------------------\n");
+
+    for (size_t n = 1000; n <= max; n *= 10) {
+      bench_parse("default", LIST_DEFAULT, n);
+      bench_parse("compact", LIST_COMPACT, n);
+    }
+
+    printf("\n%-10s %10s %12s %12s %12s %12s\n", "storage", "values",
+           "text (ms)", "json (ms)", "csv (ms)", "binary (ms)");
+    printf("------------------------------------------------------------------------\n");
+
+    for (size_t n = 1000; n <= max; n *= 10) {
+      bench_write("default", LIST_DEFAULT, n);
+      bench_write("compact", LIST_COMPACT, n);
+    }
+
+    printf("\n%-10s %10s %12s %12s\n", "storage", "values",
+           "threads", "move (ms)");
+    printf("-----------------------------------------------------------\n");
+
+    for (size_t n = 1000; n <= max; n *= 10) {
+      bench_queue("list", false, 1, n);
+      bench_queue("queue", true, 1, n);
+      bench_queue("list", false, 4, n);
+      bench_queue("queue", true, 4, n);
+    }
+
+    printf("\n%-10s %10s %12s %12s\n", "storage", "values",
+           "threads", "append (ms)");
+    printf("-----------------------------------------------------------\n");
+
+    for (size_t n = 1000; n <= max; n *= 10) {
+      bench_append("default", LIST_DEFAULT, 1, n);
+      bench_append("sharded", LIST_SHARDED, 1, n);
+      bench_append("default", LIST_DEFAULT, 8, n);
+      bench_append("sharded", LIST_SHARDED, 8, n);
+    }
+
+    printf("\n%-10s %10s %8s %9s %9s %9s %9s %9s %9s\n", "storage", "ops",
+           "threads", "ms", "locks", "waited %", "wait ms", "timeouts", "bytes/val");
+    printf("----------------------------------------------------------------------------------------\n");
+
+    for (size_t t = 1; t <= 64; t *= 4) {
+      bench_mixed("default", LIST_DEFAULT, t, 100000);
+      bench_mixed("compact", LIST_COMPACT, t, 100000);
+    }
+
+    return EXIT_SUCCESS;
+}
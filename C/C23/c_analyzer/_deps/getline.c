@@ -1,61 +0,0 @@
-// inspiration: https://github.com/msys2/MINGW-packages/blob/master/mingw-w64-libgd/mingw-getline-link.patch
-
-#ifdef __unix__
-#  warning "Your OS should already have 'getline()'. Check your POSIX defines."
-#endif
-
-#include <stdio.h>
-#include <stdlib.h>
-
-ssize_t getline(char **restrict lineptr, size_t *restrict n, FILE *restrict stream)
-{
-    char *bufptr = NULL;
-    char *p = bufptr;
-    size_t size;
-    int c;
-
-    if (lineptr == NULL) {
-        return -1;
-    }
-    if (stream == NULL) {
-        return -1;
-    }
-    if (n == NULL) {
-        return -1;
-    }
-    bufptr = *lineptr;
-    size = *n;
-
-    c = fgetc(stream);
-    if (c == EOF) {
-        return -1;
-    }
-    if (bufptr == NULL) {
-        bufptr = malloc(128);
-        if (bufptr == NULL) {
-            return -1;
-        }
-        size = 128;
-    }
-    p = bufptr;
-    while(c != EOF) {
-        if ((p - bufptr) > (size - 1)) {
-            size = size + 128;
-            bufptr = realloc(bufptr, size);
-            if (bufptr == NULL) {
-                return -1;
-            }
-        }
-        *p++ = c;
-        if (c == '\n') {
-            break;
-        }
-        c = fgetc(stream);
-    }
-
-    *p++ = '\0';
-    *lineptr = bufptr;
-    *n = size;
-
-    return p - bufptr;
-}
\ No newline at end of file
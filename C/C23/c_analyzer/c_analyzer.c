@@ -18,31 +18,37 @@
 
 //  Compile with:
 // * Linux:   gcc -std=c23 ...
-// * Windows: gcc -std=c23 -I_deps _deps/getline.c ...
+// * Windows: gcc -std=c23 -I_deps ...
+//  (add "-DHAVE_LIBMAGIC ... -lmagic" for "--strict" to use libmagic)
 
-#define _GNU_SOURCE   // for "popen()/pclose()","asprintf()","getline()"
+#define _GNU_SOURCE   // for "popen()/pclose()","asprintf()"
 #include <assert.h>
+#include <ctype.h>
+#include <stdatomic.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <threads.h>
 #include <unistd.h>
 #include <dirent.h>
 
+#ifdef HAVE_LIBMAGIC
+#  include <magic.h>
+#endif
+
 #include "plugins/plugin.h"
 
 #ifdef _WIN32
 #  include <windows.h>
 #  define popen  _popen
 #  define pclose _pclose
-   extern ssize_t getline(char **restrict l, size_t *restrict n, FILE *restrict s);
    constexpr char DIR_SEP[] = {'\\','/'};
    constexpr char PLG_EXT[] = ".dll";
-   constexpr char CLEAR_COMMAND[] = "cls";
 #else
 #  define MAX_PATH 260
    constexpr char DIR_SEP[] = {'/'};
    constexpr char PLG_EXT[] = ".so";
-   constexpr char CLEAR_COMMAND[] = "clear";
 #endif
 constexpr char PLG_DIR[] = "plugins/";
 
@@ -52,20 +58,34 @@ constexpr char PLG_DIR[] = "plugins/";
 #  define __counted_by(member)
 #endif
 
-size_t __;
-#define GETLINE(X,Y)        getline((X),&__,(Y))
 #define ASPRINTF(X,Y,Z,...) assert(asprintf((X),(Y),(Z) __VA_OPT__(,) __VA_ARGS__) != -1)
 #define FOR_EACH(X,Y)       for (typeof(Y) (X) = 0; (X) < (Y); (X)++)
 
 
+typedef struct {
+    bool hit;
+    Err err;
+} Finding;
+
+typedef enum : unsigned char {
+    E_PENDING = 0, E_NOT_FOUND, E_NOT_C, E_UNREADABLE, E_ANALYZED
+} Estatus;
+
 typedef struct {
     char* path;
-    FILE* file;
+    Estatus status;
+
+    char* data;
+    Finding* findings;        // (one per plugin)
+    Finding* chunk_findings;  // (one per plugin and per chunk, if split)
+    size_t chunks;
+    atomic_size_t pending;
 } File;
 
 typedef struct {
     size_t count;
-    File* files[] __counted_by(count);
+    size_t size;
+    File files[] __counted_by(size);
 } Files;
 
 typedef struct {
@@ -73,6 +93,15 @@ typedef struct {
     Plugin* plugins[] __counted_by(count);
 } Plugins;
 
+typedef struct {
+    bool strict;
+    size_t jobs;
+} Options;
+
+constexpr long MAX_JOBS = 1024;
+
+Options options = { .jobs = 1 };
+
 
 // FILE PARSING
 
@@ -81,119 +110,441 @@ typedef enum : signed char {
 } Etest;
 
 
-bool file_is_c_source(const char* path)
+constexpr size_t SNIFF_SIZE = 4096;
+
+ // SWAR: true if any byte is a control character below '\t' (NUL included),
+ // which never happens in a C source file
+bool sniff_is_binary(const unsigned char* buf, size_t size)
 {
-    constexpr char FILE_COMMAND[] = "file %s";
+    constexpr uint64_t ONES  = 0x0101010101010101ull;
+    constexpr uint64_t HIGHS = 0x8080808080808080ull;
+
+    size_t i = 0;
+    for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+        uint64_t x;
+        memcpy(&x, buf + i, sizeof(x));
+        if ((x - ONES*'\t') & ~x & HIGHS) {
+            return true; }
+    }
+    for (; i < size; i++) {
+        if (buf[i] < '\t') {
+            return true; }
+    }
+    return false;
+}
 
-    bool res = false;
-    static Etest has_file_tool = E_UNTESTED;
+bool sniff_has_c_tokens(const char* buf)
+{
+    static const char* TOKENS[] = {
+        "#include", "#define", "#ifndef", "#ifdef", "#pragma",
+        "typedef ", "struct ", "int main(" };
 
-    if (has_file_tool == E_UNTESTED) {
-        auto f = popen(FILE_COMMAND, "r");
-        has_file_tool = (f && abs(pclose(f)) != 1) ? true : false;
-        system(CLEAR_COMMAND);
+    FOR_EACH(t, sizeof(TOKENS)/sizeof(*TOKENS)) {
+        if (strstr(buf, TOKENS[t])) {
+            return true; }
     }
+    return false;
+}
+
+ // of the file name itself (a dot in a directory name is none), or nullptr
+const char* file_extension(const char* path)
+{
+    auto name = path;
+    for (auto p = path; *p; p++) {
+        if (memchr(DIR_SEP, *p, sizeof(DIR_SEP))) {
+            name = p + 1; }
+    }
+    return strrchr(name, '.');
+}
 
-    if (has_file_tool) {
-        char *cmd, *out = nullptr;
-        FILE* fout = nullptr;
+bool file_has_c_extension(const char* path)
+{
+    const char* ext = nullptr;
 
-        ASPRINTF(&cmd, FILE_COMMAND, path);
-        if ((fout = popen(cmd, "r")) &&
-              GETLINE(&out, fout) != -1 &&
-                abs(pclose(fout)) != 1) {
-            res = strstr(out, "C source");
-            free(out);
-        }
-        free(cmd);
-    } else {
-        char* ext = nullptr;
+    return (ext = file_extension(path)) &&
+             (!strcmp(ext, ".c") || !strcmp(ext, ".h"));
+}
+
+#ifdef HAVE_LIBMAGIC
+ // one cookie for all workers: opened once, and used under a lock since
+ // magic_buffer() writes its answer into the cookie
+once_flag magic_once = ONCE_FLAG_INIT;
+magic_t magic_cookie = nullptr;
+mtx_t magic_lock;
 
-        if ((ext = strrchr(path, '.')) &&
-              (!strcmp(ext, ".c") || !strcmp(ext, ".h"))) {
-            res = true; }
+void magic_open_cookie(void)
+{
+    auto cookie = magic_open(MAGIC_NONE);
+    if (!cookie || magic_load(cookie, nullptr) || mtx_init(&magic_lock, mtx_plain) != thrd_success) {
+        fprintf(stderr, "libmagic: %s.\n", cookie ? magic_error(cookie) : "no memory");
+        if (cookie) {
+            magic_close(cookie); }
+        return;
     }
+    magic_cookie = cookie;
+}
 
-    return res;
+void magic_close_cookie(void)
+{
+    if (magic_cookie) {
+        magic_close(magic_cookie);
+        mtx_destroy(&magic_lock);
+        magic_cookie = nullptr;
+    }
 }
 
-bool open_files(Files** out, const char** paths, const int count)
+bool file_is_c_source_magic(const char* buf, size_t size)
 {
-    auto files = *out;
+    call_once(&magic_once, magic_open_cookie);
+    if (!magic_cookie) {
+        return false; }
 
-    FOR_EACH(c, (int) count)
+    mtx_lock(&magic_lock);
+    auto out = magic_buffer(magic_cookie, buf, size);
+    bool is_c = out && strstr(out, "C source");
+    mtx_unlock(&magic_lock);
+
+    return is_c;
+}
+#endif
+
+bool file_is_c_source(const char* path, FILE* file)
+{
+    char buf[SNIFF_SIZE + 1];
+
+    auto size = fread(buf, 1, SNIFF_SIZE, file);
+    rewind(file);
+
+    if (sniff_is_binary((unsigned char*) buf, size)) {
+        return false; }
+    buf[size] = '\0';
+
+    if (options.strict) {
+#     ifdef HAVE_LIBMAGIC
+        return file_is_c_source_magic(buf, size);
+#     else
+        return file_has_c_extension(path) && sniff_has_c_tokens(buf);
+#     endif
+    }
+
+    // any other extension (".cpp", ".cc", ".txt"...) says it is not C, whatever
+    // its tokens; only files without one are judged on their contents
+    if (file_extension(path)) {
+        return file_has_c_extension(path); }
+    return sniff_has_c_tokens(buf);
+}
+
+[[nodiscard("Leaking unused buffer")]]
+char* read_file(FILE* f, size_t* size)
+{
+    char* data = nullptr;
+    long len = 0;
+
+    if (fseek(f, 0, SEEK_END) || (len = ftell(f)) < 0) {
+        return nullptr; }
+    rewind(f);
+
+    // (+1 so that the last line can always be NUL-terminated in place)
+    if (!(data = malloc(len + 1))) {
+        return nullptr; }
+    // what "fread()" got, not "ftell()": a text-mode stream (or a file
+    // shrinking meanwhile) reads back fewer bytes
+    size_t got = fread(data, 1, len, f);
+    if (ferror(f)) {
+        free(data);
+        return nullptr;
+    }
+    data[got] = '\0';
+
+    *size = got;
+    return data;
+}
+
+void analyze_lines(Plugins* plugins, char* begin, char* end, size_t num, Finding* findings)
+{
+     // single pass: split lines in place, and feed each one to every plugin
+    for (char* line = begin; line < end; )
     {
-        FILE* f = nullptr;
-        if (!(f = fopen(paths[c], "r"))) {
-            fprintf(stderr, "File '%s' not found: ignored.\n", paths[c]);
-            continue;
+        char* eol = nullptr;
+        if (!(eol = memchr(line, '\n', end - line))) {
+            eol = end; }
+        *eol = '\0';
+        if (eol > line && eol[-1] == '\r') {
+            eol[-1] = '\0'; }    // CRLF: plugins get the same line as with LF
+        num++;
+
+        FOR_EACH(c, plugins->count)
+        {
+            auto plugin = plugins->plugins[c];
+
+            switch (plugin->method)
+            {
+              case E_BOTH: [[fallthrough]];
+              case E_LINE:
+                  findings[c].hit |= plugin->analyze_line(plugin, line, num);
+                  [[fallthrough]];
+              case E_BLOCK:
+                  // TODO: handle this
+                  [[fallthrough]];
+              default:
+                  continue;
+            }
         }
-        if (!file_is_c_source(paths[c])) {
-            fprintf(stderr, "File '%s' is not C: ignored.\n", paths[c]);
-            fclose(f);
-            continue;
+        line = eol + 1;
+    }
+
+     // take the errors over, as plugin instances move on to other files
+    FOR_EACH(c, plugins->count)
+    {
+        if (!findings[c].hit) {
+            continue; }
+
+        findings[c].err = plugins->plugins[c]->err;
+        plugins->plugins[c]->err = (Err){};
+    }
+}
+
+size_t count_lines(const char* begin, const char* end)
+{
+    size_t lines = 0;
+
+    for (const char* p = begin; (p = memchr(p, '\n', end - p)); p++) {
+        lines++; }
+
+    return lines;
+}
+
+void report_files(File* files, size_t count, Plugins* plugins)
+{
+    FOR_EACH(f, count)
+    {
+        auto file = &files[f];
+        switch (file->status)
+        {
+          case E_NOT_FOUND:
+              fprintf(stderr, "File '%s' not found: ignored.\n", file->path);
+              continue;
+          case E_NOT_C:
+              fprintf(stderr, "File '%s' is not C: ignored.\n", file->path);
+              continue;
+          case E_UNREADABLE:
+              fprintf(stderr, "File '%s' could not be read: ignored.\n", file->path);
+              continue;
+          default:
+              break;
+        }
+
+        FOR_EACH(c, plugins->count)
+        {
+            auto finding = &file->findings[c];
+            if (finding->hit) {
+                fprintf(stderr, "[File] '%s':\n", file->path);
+                report_err(&finding->err);
+            }
+            clear_err(&finding->err);
         }
+        free(file->findings);
+        file->findings = nullptr;
+    }
+}
+
 
-        File* file = calloc(1, sizeof(File));
-        file->path = (char*) paths[c];
-        file->file = f;
+// FILE LISTING
 
-        files->count++;
-        files = realloc(files, sizeof(Files) + files->count*sizeof(File*));
-        files->files[files->count-1] = file;
+ // (files are only opened when analyzed: the list may be huge)
+void add_file(Files** out, const char* path)
+{
+    auto files = *out;
+
+    if (files->count == files->size) {
+        files->size = files->size ? files->size*2 : 64;
+        files = realloc(files, sizeof(Files) + files->size*sizeof(File));
     }
+    files->files[files->count++] = (File){ .path = strdup(path) };
 
     *out = files;
-    return (files->count > 0);
 }
 
-void analyze_file(File* file, Plugins* plugins)
+[[nodiscard("Leaking unused string")]]
+char* join_path(const char* dir, const char* name)
+{
+    char* path = nullptr;
+    auto len = strlen(dir);
+
+    if (len && memchr(DIR_SEP, dir[len-1], sizeof(DIR_SEP))) {
+        ASPRINTF(&path, "%s%s", dir, name); }
+    else {
+        ASPRINTF(&path, "%s%c%s", dir, DIR_SEP[0], name); }
+
+    return path;
+}
+
+ // recursive, sorted (for a reproducible report), skips hidden entries;
+ // returns false if "path" is not a directory
+bool walk_directory(Files** out, const char* path)
 {
-    FOR_EACH(c, plugins->count)
+    struct dirent** ents = nullptr;
+    int count = 0;
+
+    if ((count = scandir(path, &ents, nullptr, alphasort)) < 0) {
+        return false; }
+
+    FOR_EACH(e, count)
     {
-        bool res = false;
-        auto plugin = plugins->plugins[c];
+        auto ent = ents[e];
+        if (ent->d_name[0] != '.')
+        {
+            auto full_path = join_path(path, ent->d_name);
+
+            if ((ent->d_type != DT_DIR && ent->d_type != DT_UNKNOWN) ||
+                  !walk_directory(out, full_path)) {
+                if (ent->d_type != DT_DIR && file_has_c_extension(full_path)) {
+                    add_file(out, full_path); }
+            }
+            free(full_path);
+        }
+        free(ent);
+    }
+    free(ents);
 
-        rewind(file->file);
+    return true;
+}
 
-        switch (plugin->method)
+ // minimal JSON reader: "file" (relative to "directory") of each top-level object
+[[nodiscard("Leaking unused string")]]
+char* json_string(char** pos)
+{
+    auto p = *pos + 1;
+    auto end = p;
+    while (*end && *end != '"') {    // escapes only shrink: size the copy first
+        end += (*end == '\\' && end[1]) ? 2 : 1; }
+
+    char* str = malloc((size_t)(end - p) + 1);
+    size_t len = 0;
+    if (!str) {
+        *pos = *end ? end + 1 : end;
+        return nullptr; }
+
+    for (; *p && *p != '"'; p++)
+    {
+        if (*p != '\\' || !p[1]) {
+            str[len++] = *p;
+            continue;
+        }
+        switch (*++p)
         {
-          case E_BOTH: [[fallthrough]];
-          case E_LINE:
-              char* line = nullptr;
-              size_t num = 0;
-
-              while (GETLINE(&line, file->file) != -1) {
-                  res |= plugin->analyze_line(plugin, line, ++num); }
-              if (line) {
-                  free(line); }
-              if (res) {
-                  goto err; }
-              [[fallthrough]];
-          case E_BLOCK:
-              // TODO: handle this
-              [[fallthrough]];
-          default:
+          case 'b': str[len++] = '\b'; break;
+          case 'f': str[len++] = '\f'; break;
+          case 'n': str[len++] = '\n'; break;
+          case 'r': str[len++] = '\r'; break;
+          case 't': str[len++] = '\t'; break;
+          case 'u':  // (non-ASCII code points never name a file here)
+              char hex[5] = {};
+              for (int i = 0; i < 4 && isxdigit((unsigned char) p[1]); i++) {
+                  hex[i] = *++p; }
+              str[len++] = (char) strtol(hex, nullptr, 16);
+              break;
+          default:   str[len++] = *p;
+        }
+    }
+    str[len] = '\0';
+
+    *pos = *p ? p + 1 : p;
+    return str;
+}
+
+bool read_compile_commands(Files** out, const char* path)
+{
+    FILE* f = nullptr;
+    if (!(f = fopen(path, "rb"))) {
+        return false; }
+
+    size_t size = 0;
+    auto data = read_file(f, &size);
+    fclose(f);
+    if (!data) {
+        return false; }
+
+    char *key = nullptr, *dir = nullptr, *file = nullptr;
+    int depth = 0;
+
+    for (char* p = data; *p; )
+    {
+        switch (*p)
+        {
+          case '"':
+              auto str = json_string(&p);
+              while (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n') {
+                  p++; }
+
+              if (depth == 2 && *p == ':') {
+                  free(key);
+                  key = str;
+              } else if (depth == 2 && key && !strcmp(key, "directory")) {
+                  free(dir);
+                  dir = str;
+              } else if (depth == 2 && key && !strcmp(key, "file")) {
+                  free(file);
+                  file = str;
+              } else {
+                  free(str); }
               continue;
-          err:
-              fprintf(stderr, "[File] '%s':\n", file->path);
-              report_err(&plugin->err);
+          case '{': [[fallthrough]];
+          case '[':
+              depth++;
+              break;
+          case '}':
+              if (depth == 2 && file) {
+                  if (dir && !(file[0] == DIR_SEP[0] || file[0] == '/' ||
+                                (file[0] && file[1] == ':'))) {
+                      auto full_path = join_path(dir, file);
+                      add_file(out, full_path);
+                      free(full_path);
+                  } else {
+                      add_file(out, file); }
+              }
+              if (depth == 2) {
+                  free(key); free(dir); free(file);
+                  key = dir = file = nullptr;
+              }
+              [[fallthrough]];
+          case ']':
+              depth--;
+              break;
         }
+        p++;
     }
+    free(key); free(dir); free(file);
+    free(data);
+
+    return true;
 }
 
-void analyze_files(Files* files, Plugins* plugins)
+bool list_files(Files** out, const char** paths, const int count)
 {
-    FOR_EACH(c, files->count) {
-        analyze_file(files->files[c], plugins); }
+    constexpr char COMPILE_COMMANDS[] = "compile_commands.json";
+
+    FOR_EACH(c, (int) count)
+    {
+        auto len = strlen(paths[c]);
+
+        if (len >= sizeof(COMPILE_COMMANDS)-1 &&
+              !strcmp(paths[c] + len - (sizeof(COMPILE_COMMANDS)-1), COMPILE_COMMANDS)) {
+            if (!read_compile_commands(out, paths[c])) {
+                fprintf(stderr, "File '%s' not readable: ignored.\n", paths[c]); }
+            continue;
+        }
+        if (!walk_directory(out, paths[c])) {
+            add_file(out, paths[c]); }
+    }
+
+    return ((*out)->count > 0);
 }
 
-void close_files(Files* files)
+void free_files(Files* files)
 {
     FOR_EACH(c, files->count) {
-        fclose(files->files[c]->file);
-        free(files->files[c]);
-    }
+        free(files->files[c].path); }
 }
 
 
@@ -327,27 +678,394 @@ bool load_plugins(Plugins** out, const char* arg)
     return (plugins->count > 0);
 }
 
-void unload_plugins(Plugins* plugins)
+void unload_plugins(Plugins* plugins, bool close_handles)
 {
     FOR_EACH(c, plugins->count) {
         auto plugin = plugins->plugins[c];
+        if (!plugin) {
+            continue; }
         plugin->unload(plugin);
-        PLG_CLOSE(plugin->handle);
+        if (close_handles) {
+            PLG_CLOSE(plugin->handle); }
         free(plugin);
     }
 }
 
+ // new instances sharing the already loaded binaries (one set per thread)
+[[nodiscard("Leaking unused Plugins")]]
+Plugins* clone_plugins(Plugins* plugins)
+{
+    Plugins* clone = calloc(1, sizeof(Plugins) + plugins->count*sizeof(Plugin*));
+    clone->count = plugins->count;
+
+    FOR_EACH(c, plugins->count) {
+        auto plugin = plugins->plugins[c];
+        PLG_LOAD plg_load = (PLG_LOAD) PLG_SYM(plugin->handle, "load");
+
+        if (!(clone->plugins[c] = plg_load(plugin->handle, plugin->name))) {
+            unload_plugins(clone, false);
+            free(clone);
+            return nullptr;
+        }
+    }
+
+    return clone;
+}
+
+
+// THREAD POOL
+
+constexpr size_t CHUNK_SIZE = 1 << 20;
+
+typedef struct {
+    File* file;
+    size_t chunk;
+    char* begin;        // (nullptr: whole file, not read yet)
+    char* end;
+    size_t line_num;    // (lines before "begin")
+} Task;
+
+ // owner pushes/pops at the back, thieves steal from the front
+typedef struct {
+    mtx_t lock;
+    size_t head, tail, size;
+    Task* tasks;
+} Deque;
+
+typedef struct Pool Pool;
+
+typedef struct {
+    Pool* pool;
+    size_t id;
+    Plugins* plugins;
+    Deque deque;
+} Worker;
+
+struct Pool {
+    bool split;
+    atomic_size_t outstanding;  // tasks pushed and not done yet
+    atomic_size_t queued;       // of which, waiting in a deque
+    atomic_size_t sleepers;
+    mtx_t lock;                 // (only for sleeping and waking up)
+    cnd_t wake;
+    size_t count;
+    Worker workers[] __counted_by(count);
+};
+
+
+void deque_push(Deque* d, Task task)
+{
+    mtx_lock(&d->lock);
+    if (d->tail == d->size) {
+        if (d->head > 0) {
+            memmove(d->tasks, d->tasks + d->head, (d->tail - d->head)*sizeof(Task));
+            d->tail -= d->head;
+            d->head = 0;
+        } else {
+            d->size = d->size ? d->size*2 : 16;
+            d->tasks = realloc(d->tasks, d->size*sizeof(Task));
+        }
+    }
+    d->tasks[d->tail++] = task;
+    mtx_unlock(&d->lock);
+}
+
+bool deque_pop(Deque* d, Task* task, bool back)
+{
+    bool res = false;
+
+    mtx_lock(&d->lock);
+    if (d->head < d->tail) {
+        *task = back ? d->tasks[--d->tail] : d->tasks[d->head++];
+        res = true;
+    }
+    mtx_unlock(&d->lock);
+
+    return res;
+}
+
+void pool_wake(Pool* pool, bool all)
+{
+    mtx_lock(&pool->lock);
+    if (all) {
+        cnd_broadcast(&pool->wake); }
+    else {
+        cnd_signal(&pool->wake); }
+    mtx_unlock(&pool->lock);
+}
+
+ // idle: sleeps until there is a task to steal, or none will ever come
+void pool_wait(Pool* pool)
+{
+    mtx_lock(&pool->lock);
+    atomic_fetch_add(&pool->sleepers, 1);
+     // (seq_cst: either a pusher sees us sleeping, or we see its task)
+    while (atomic_load(&pool->outstanding) && !atomic_load(&pool->queued)) {
+        cnd_wait(&pool->wake, &pool->lock); }
+    atomic_fetch_sub(&pool->sleepers, 1);
+    mtx_unlock(&pool->lock);
+}
+
+void pool_push(Worker* w, Task task)
+{
+    auto pool = w->pool;
+
+    atomic_fetch_add(&pool->outstanding, 1);
+    atomic_fetch_add(&pool->queued, 1);
+    deque_push(&w->deque, task);
+    if (atomic_load(&pool->sleepers)) {
+        pool_wake(pool, false); }
+}
+
+bool pool_steal(Worker* w, Task* task)
+{
+    auto pool = w->pool;
+
+    for (size_t i = 1; i < pool->count; i++) {
+        if (deque_pop(&pool->workers[(w->id + i) % pool->count].deque, task, false)) {
+            return true; }
+    }
+    return false;
+}
+
+ // the last chunk of a file keeps, per plugin, the last error found (as a serial run would)
+void file_done(File* file, size_t count)
+{
+    free(file->data);
+    file->data = nullptr;
+
+    if (!file->chunk_findings) {
+        return; }
+
+    FOR_EACH(k, file->chunks) {
+        FOR_EACH(c, count) {
+            auto finding = &file->chunk_findings[k*count + c];
+            if (!finding->hit) {
+                continue; }
+            clear_err(&file->findings[c].err);
+            file->findings[c] = *finding;
+        }
+    }
+    free(file->chunk_findings);
+    file->chunk_findings = nullptr;
+}
+
+void chunk_done(File* file, size_t count)
+{
+    if (atomic_fetch_sub(&file->pending, 1) == 1) {
+        file_done(file, count); }
+}
+
+void run_task(Worker* w, Task* task)
+{
+    auto file = task->file;
+    auto count = w->plugins->count;
+
+    if (task->begin) {
+        analyze_lines(w->plugins, task->begin, task->end, task->line_num,
+                        &file->chunk_findings[task->chunk*count]);
+        chunk_done(file, count);
+        return;
+    }
+
+    FILE* f = nullptr;
+    if (!(f = fopen(file->path, "rb"))) {
+        file->status = E_NOT_FOUND;
+        return;
+    }
+    if (!file_is_c_source(file->path, f)) {
+        file->status = E_NOT_C;
+        fclose(f);
+        return;
+    }
+
+    size_t size = 0;
+    file->data = read_file(f, &size);
+    fclose(f);
+    if (!file->data) {
+        file->status = E_UNREADABLE;
+        return;
+    }
+    file->findings = calloc(count, sizeof(Finding));
+    file->status = E_ANALYZED;
+
+    auto end = file->data + size;
+
+    if (!w->pool->split || size <= CHUNK_SIZE) {
+        analyze_lines(w->plugins, file->data, end, 0, file->findings);
+        file_done(file, count);
+        return;
+    }
+
+     // big file, stateless plugins: split at line boundaries, let idle workers steal chunks
+    file->chunk_findings = calloc((size/CHUNK_SIZE + 1)*count, sizeof(Finding));
+    atomic_store(&file->pending, 1);
+
+    size_t lines = 0, k = 0;
+    for (char* begin = file->data; begin < end; k++)
+    {
+        char* cut = nullptr;
+        if ((size_t) (end - begin) > CHUNK_SIZE &&
+              (cut = memchr(begin + CHUNK_SIZE, '\n', end - begin - CHUNK_SIZE))) {
+            cut++; }
+        else {
+            cut = end; }
+
+         // (count before pushing: once stolen, the chunk gets its newlines overwritten)
+        auto chunk_lines = count_lines(begin, cut);
+
+        atomic_fetch_add(&file->pending, 1);
+        pool_push(w, (Task){ .file = file, .chunk = k, .begin = begin, .end = cut, .line_num = lines });
+
+        lines += chunk_lines;
+        begin = cut;
+    }
+    file->chunks = k;
+
+    chunk_done(file, count);
+}
+
+int run_worker(void* arg)
+{
+    Worker* w = arg;
+    auto pool = w->pool;
+    Task task;
+
+    while (atomic_load(&pool->outstanding))
+    {
+        if (!deque_pop(&w->deque, &task, true) && !pool_steal(w, &task)) {
+            pool_wait(pool);
+            continue;
+        }
+        atomic_fetch_sub(&pool->queued, 1);
+        run_task(w, &task);
+        if (atomic_fetch_sub(&pool->outstanding, 1) == 1) {
+            pool_wake(pool, true); }
+    }
+
+    return 0;
+}
+
+bool plugins_are_stateless(Plugins* plugins)
+{
+    FOR_EACH(c, plugins->count) {
+        auto plugin = plugins->plugins[c];
+        if (plugin->method == E_BLOCK) {
+            continue; }
+
+        auto stateless = (const bool*) PLG_SYM(plugin->handle, "stateless");
+        PLG_ERR();   // (not exporting it is no error)
+        if (!stateless || !*stateless) {
+            return false; }
+    }
+    return true;
+}
+
+void run_batch(Pool* pool, File* files, size_t count)
+{
+    auto jobs = pool->count;
+
+     // (deal files round-robin, then let workers steal from each other)
+    FOR_EACH(c, count) {
+        pool_push(&pool->workers[c % jobs], (Task){ .file = &files[c] }); }
+
+     // (files dealt to workers that did not start get stolen by the others)
+    thrd_t* threads = calloc(jobs, sizeof(thrd_t));
+    size_t started = 1;
+    while (threads && started < jobs &&
+           thrd_create(&threads[started], run_worker, &pool->workers[started]) == thrd_success) {
+        started++; }
+    if (started < jobs) {
+        fprintf(stderr, "[WARNING] Could not start threads: using %zu.\n", started); }
+
+    run_worker(&pool->workers[0]);
+    for (size_t j = 1; j < started; j++) {
+        thrd_join(threads[j], nullptr); }
+    free(threads);
+}
+
+void analyze_files(Files* files, Plugins* plugins, size_t jobs)
+{
+    constexpr size_t BATCH_SIZE = 1024;
+
+    Pool* pool = calloc(1, sizeof(Pool) + jobs*sizeof(Worker));
+    if (!pool) {
+        fprintf(stderr, "[ERROR] Out of memory for %zu threads! Exiting...\n", jobs);
+        exit(EXIT_FAILURE);
+    }
+    pool->count = jobs;
+    pool->split = (jobs > 1) && plugins_are_stateless(plugins);
+
+    FOR_EACH(j, jobs) {
+        auto w = &pool->workers[j];
+        w->pool = pool;
+        w->id   = j;
+        w->plugins = j ? clone_plugins(plugins) : plugins;
+        if (!w->plugins) {
+            fprintf(stderr, "[WARNING] Could not clone plugins: using %zu thread(s).\n", j);
+            pool->count = jobs = j;
+            break;
+        }
+        mtx_init(&w->deque.lock, mtx_plain);
+    }
+
+    mtx_init(&pool->lock, mtx_plain);
+    cnd_init(&pool->wake);
+
+     // one batch at a time, so that findings of a huge list never pile up
+    for (size_t b = 0; b < files->count; b += BATCH_SIZE)
+    {
+        auto count = (files->count - b < BATCH_SIZE) ? files->count - b : BATCH_SIZE;
+
+        run_batch(pool, &files->files[b], count);
+        report_files(&files->files[b], count, plugins);
+    }
+
+    FOR_EACH(j, jobs) {
+        auto w = &pool->workers[j];
+        if (j) {
+            unload_plugins(w->plugins, false);
+            free(w->plugins);
+        }
+        mtx_destroy(&w->deque.lock);
+        free(w->deque.tasks);
+    }
+    cnd_destroy(&pool->wake);
+    mtx_destroy(&pool->lock);
+    free(pool);
+}
+
 
 int main(int argc, char* argv[])
 {
-    if (argc < 2) {
-        printf("Usage: %s <file1>.c <file2>.c ...\n\n", argv[0]);
+    auto paths = (const char**) argv+1;
+    int count = 0;
+
+    for (int a = 1; a < argc; a++) {
+        if (!strcmp(argv[a], "--strict")) {
+            options.strict = true; }
+        else if (!strncmp(argv[a], "-j", 2)) {
+            auto arg = argv[a][2] ? &argv[a][2] : (a+1 < argc) ? argv[++a] : "";
+            char* end = nullptr;
+            auto jobs = strtol(arg, &end, 10);
+            if (end == arg || *end || jobs < 1 || jobs > MAX_JOBS) {
+                fprintf(stderr, "[ERROR] -j takes a number of threads, 1 to %ld! Exiting...\n", MAX_JOBS);
+                return EXIT_FAILURE;
+            }
+            options.jobs = jobs;
+        }
+        else {
+            paths[count++] = argv[a]; }
+    }
+
+    if (count < 1) {
+        printf("Usage: %s [--strict] [-j N] <file1>.c <dir> <compile_commands.json> ...\n\n", argv[0]);
         return EXIT_SUCCESS;
     }
 
     Files* files = calloc(1, sizeof(Files));
 
-    if (!open_files(&files, (const char**) argv+1, argc-1)) {
+    if (!list_files(&files, paths, count)) {
         fprintf(stderr, "[ERROR] No valid source file found! Exiting...\n");
         free(files);
         return EXIT_FAILURE;
@@ -357,16 +1075,21 @@ int main(int argc, char* argv[])
 
     if (!load_plugins(&plugins, (const char*) argv[0])) {
         fprintf(stderr, "[ERROR] No valid plugin found! Exiting...\n");
-        free(plugins); free(files);
+        free(plugins);
+        free_files(files);
+        free(files);
         return EXIT_FAILURE;
     }
 
-    analyze_files(files, plugins);
+    analyze_files(files, plugins, options.jobs);
+#   ifdef HAVE_LIBMAGIC
+    magic_close_cookie();
+#   endif
 
-    unload_plugins(plugins);
+    unload_plugins(plugins, true);
     free(plugins);
 
-    close_files(files);
+    free_files(files);
     free(files);
 
     return EXIT_SUCCESS;
@@ -99,3 +99,8 @@ struct Plugin
 
     Err err;
 };
+
+ // Optional symbols (looked up by name, so plugins built without them load
+ // as they are)
+ //  'stateless': a 'const bool', true if lines may be analyzed out of order,
+ //               by several threads
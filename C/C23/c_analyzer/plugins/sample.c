@@ -28,6 +28,8 @@ static constexpr char PLUGIN_COMMENT[] = "Sample plugin that detects a string.";
 
 constexpr char BAD_STRING[] = "ERROR";
 
+PUBLIC const bool stateless = true;    // we keep nothing from line to line
+
 
 PRIVATE
 void my_err_message(char** out, const char* line, const char* found)
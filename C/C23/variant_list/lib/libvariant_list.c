@@ -20,11 +20,31 @@
 
 #define _GNU_SOURCE  // for "asprintf()"-stdio.h
 #include <stdio.h>   // for "(f)printf()"...
+#include <stdarg.h>  // for "va_list"
 #include <stdlib.h>  // for "atoi()","strtod()"...
 #include <string.h>  // for "strcmp()","memcpy()"...
-#include <math.h>    // for "lround()"
+#include <math.h>    // for "lround()","trunc()"
+#include <float.h>   // for "FLT_EVAL_METHOD"
+#include <locale.h>  // for "newlocale()","strtod_l()","uselocale()"
+#include <stdint.h>  // for "uint64_t"
+#include <inttypes.h> // for "PRId64"
+#include <limits.h>  // for "INT_MIN","INT_MAX"
 #include <time.h>    // for "timespec_*"-C11,C23
+#include <stdatomic.h> // for "atomic_*"-C11,C23
 #include <threads.h> // for "mutex_*"-C11,C23
+#ifdef _WIN32
+#  include <windows.h> // for "GetSystemInfo()","MapViewOfFile()"
+#  include <io.h>    // for "_commit()","_write()"
+#else
+#  include <unistd.h> // for "sysconf()","close()","write()"
+#  include <fcntl.h> // for "open()"
+#  include <sys/stat.h> // for "fstat()"
+#  include <sys/mman.h> // for "mmap()","shm_open()"
+#  include <signal.h> // for "kill()"
+#endif
+#if defined(__x86_64__) || defined(__i386__)
+#  include <immintrin.h> // for "_mm_*"-SSE2,"_mm256_*"-AVX2
+#endif
 
 #include "variant_list.h"
 
@@ -49,76 +69,418 @@
 static_assert(sizeof(NULL) == sizeof(void(*)()), "NULL non-castable");
 static_assert(sizeof(nullptr) == sizeof(nullptr_t), "nullptr non-castable");
 
+ // AVX2 code paths get compiled anyway, and picked at runtime
+#if defined(__x86_64__) || defined(__i386__)
+#  define SIMD_X86
+#  define AVX2 __attribute__ ((target ("avx2")))
+#  define HAVE_AVX2() __builtin_cpu_supports("avx2")
+#endif
+
 
 // PRIVATE TYPES
 
-typedef enum { T_UNDEF, T_INTEGER, T_BOOLEAN, T_FLOAT, T_STRING } ValueType;
+typedef enum { T_UNDEF, T_INTEGER, T_BOOLEAN, T_FLOAT, T_STRING, T_INT64, T_BLOB } ValueType;
 
-typedef struct Value Value;
+typedef struct ListValue Value;
 
-struct Value
+struct ListValue
 {
     size_t idx;
 
     ValueType t;
-    union { int i; bool b; double f; char* s; }; /* C11,C23: anonymous, do
-                                                    "val->i", "val->b"... */
+    uint32_t n;           // T_BLOB: size (bytes in "c" up to BLOB_INLINE, else at "p")
+    union { int i; bool b; double f; char* s;
+            int64_t l; const uint8_t* p; uint8_t c[8]; }; /* C11,C23: anonymous, do
+                                                             "val->i", "val->b"... */
     Value* next;
+    Value* prev;
+};
+
+ // LIST_COMPACT: 1 tag byte + 1 payload word per value, short strings inline,
+ // short blobs too (their size in the last byte), long ones by arena record
+#define T_SSTR  (T_STRING | 0x80)
+#define T_SBLOB (T_BLOB | 0x80)
+
+typedef union { int i; bool b; double f; char* s; char c[8]; } Payload;
+
+static_assert(sizeof(Payload) == 8, "Payload not 8-byte"); // C23
+
+#define BLOB_INLINE (sizeof(Payload) - 1)
+#define BLOB_HEADER 4     // records: u32 size, then the bytes
+
+#define _value_bytes(V)     (((V)->n <= BLOB_INLINE) ? (V)->c : (V)->p)
+#define _value_long_blob(V) ((V)->t == T_BLOB && (V)->n > BLOB_INLINE)
+
+typedef struct Arena Arena;
+
+ // strings (replayed from a journal) and long blobs owned by the list;
+ // blocks are shared with the snapshots that may point into them
+struct Arena
+{
+    Arena* next;
+    atomic_size_t refs;
+    size_t used;
+    size_t size;
+    char data[];
 };
 
+ // "list_snapshot()": LIST_COMPACT arrays shared by a list and its snapshots,
+ // freed by the last one out; snapshots only read their own slots, so the
+ // list writes past them as it likes, and copies the arrays before others
+typedef struct
+{
+    atomic_size_t refs;
+    uint8_t* tags;        // allocations, front gap included
+    Payload* data;
+    size_t lo, hi;        // slots seen by snapshots
+    Arena** held;         // arena blocks their values may point into
+    size_t held_count;
+} Frozen;
+
+ // a position in either storage ("scratch" receives decoded LIST_COMPACT values)
+typedef struct
+{
+    size_t idx;
+    Value* node;
+    Value scratch;
+} Cursor;
+
+ // LIST_HASHINDEX: (type,value) hash -> node (or LIST_COMPACT slot); entries
+ // are kept dense, and chained per bucket through their "next" position
+#define INDEX_NIL SIZE_MAX
+
+typedef struct
+{
+    uint64_t hash;
+    size_t next;
+    union { Value* node; size_t slot; };  // slot: position plus "origin"
+} IndexEntry;
+
+typedef struct
+{
+    size_t* heads;        // "mask + 1" buckets
+    size_t mask;
+
+    IndexEntry* entries;
+    size_t count;
+    size_t capacity;
+} Index;
+
+#define CACHE_LINE 64
+
+ // "list_create_queue()": a ring of cells, each with a sequence number telling
+ // whose turn it is (see "_queue_try_push()"); producers and consumers only
+ // meet on their own end, hence the padding
+typedef struct
+{
+    atomic_size_t seq;
+    Value v;
+} QueueCell;
+
+typedef struct
+{
+    atomic_size_t head;   // next to pop
+    char pad1[CACHE_LINE - sizeof(atomic_size_t)];
+    atomic_size_t tail;   // next to push
+    char pad2[CACHE_LINE - sizeof(atomic_size_t)];
+
+    QueueCell* cells;
+    size_t mask;
+
+    mtx_t lock;           // for threads waiting on a full/empty queue only
+    cnd_t changed;
+    atomic_size_t sleepers;
+} Queue;
+
+ // "list_create_shared()": at the start of the shared memory, the same in
+ // all processes (lock-free atomics only, offsets instead of pointers)
+typedef struct
+{
+    atomic_uint magic;        // set last by the creator
+    uint32_t version;
+    uint64_t capacity;
+    uint64_t heap_size;
+    atomic_size_t reserved;   // slots taken by adds (all below it, or being taken)
+    atomic_size_t length;     // slots readable: all ready below it
+    atomic_size_t heap_used;
+    atomic_size_t attached;   // lists on it, in all processes
+} SharedHeader;
+
+ // "list_watch()" entries
+typedef struct
+{
+    ListWatch fn;
+    void* data;
+} Watch;
+
+typedef struct
+{
+    char* path;           // "<path>.snap" holds the last checkpoint
+    FILE* f;
+    uint64_t generation;  // of the checkpoint this journal follows
+
+    unsigned int sync_every;
+    size_t pending;       // operations not fsync'ed yet
+    size_t records;       // since the last checkpoint
+} Journal;
+
+ // LIST_SHARDED: appends gather in per-thread chains, merged into the list
+ // by whoever locks it next (see "_shards_merge()"); one cache line apart
+typedef struct
+{
+    mtx_t lock;
+    Value* first;
+    Value* last;
+    size_t count;
+    struct timespec since;    // of "first"
+    char pad[CACHE_LINE];
+} Shard;
+
+typedef struct
+{
+    Shard* shards;
+    size_t count;
+    atomic_size_t pending;    // values in all shards, so that merges are cheap
+} Shards;
+
 struct List
 {
     size_t length;
 
     unsigned int timeout;
     mtx_t locked;         // C11,C23
+    atomic_uintptr_t owner; // "_list_lock()": the holding thread's "_thread_id", or 0
+    size_t depth;           // its nested locks
+
+    unsigned int flags;   // LIST_* options
 
     Value* first;
     Value* last;
+    size_t origin;        // node "idx"/index slot minus position (see "_list_reindex()")
+
+    uint8_t* tags;        // LIST_COMPACT storage
+    Payload* data;
+    size_t capacity;
+    size_t gap;           // free slots before "tags"/"data", left by the front
+    Frozen* frozen;       // "tags"/"data" shared with snapshots (or owned by one)
+
+    Index index;          // LIST_HASHINDEX lookups
+
+    void* map;            // "list_map()"/"list_snapshot()": read-only, "tags"/"data" inside
+    size_t map_size;
+    const char* heap;     // strings are offsets in there
+    size_t heap_size;
+
+    Journal* journal;     // "list_open_journal()"
+    Arena* arena;
+
+    Queue* queue;         // "list_create_queue()", "length" stays 0 then
+    Shards* shards;       // LIST_SHARDED
+    SharedHeader* shared; // "list_create_shared()": at "map", "length" follows it
+    char* shared_name;
+
+    size_t locks;         // "list_stats()" (counted under the lock)
+    size_t contended;
+    uint64_t wait_ns;
+    atomic_size_t timeouts;
+
+    cnd_t changed;        // "list_wait_length()" callers sleep on it...
+    atomic_size_t waiters; // ...if any (else changes skip the signal)
+    Watch* watches;       // "list_watch()"
+    size_t watch_count;
+    bool notifying;       // (watches changing the list do not re-run them)
+};
+
+struct ListIter
+{
+    List* list;           // locked from "list_iter_begin()" to "list_iter_end()"
+
+    size_t next;
+    Cursor at;
+    Value* cur;           // nullptr outside of [first,last]
 };
 
 
 // PRIVATE FUNCTIONS
 
-#define LIST_INSERT_CHECK(L, V) list_insert(L, (L != nullptr) ? L->length : 0, V)
+#define IDX_END SIZE_MAX  // wherever the end is once locked (others may pop)
 
-#define LIST_INSERT_CHECK_IMPL(L, I, T) \
-    if (!L || L->length < I) {          \
-        return errno = EINVAL; }        \
-    Value* v = _value_create(I);        \
-    _value_set(v, T);                   \
-    return _list_add_value(L, v);
+#define LIST_INSERT_CHECK(L, V) list_insert(L, IDX_END, V)
+
+#define LIST_INSERT_CHECK_IMPL(L, I, T)           \
+    if (!L || (I != IDX_END && _list_length(L) < I)) { \
+        return errno = EINVAL; }                  \
+    Value v = { .idx = I };             \
+    _value_set(&v, T);                  \
+    return _list_add_value(L, &v);
 
 #define LIST_GET_CHECK_IMPL(L, I, T)         \
-    if (!L || L->length <= I) {              \
+    if (!L || _list_length(L) <= I) {        \
         return errno = EINVAL; }             \
-    Value* v = _value_create(I);             \
+    Value* v = _value_create(L, I);          \
     if (errno = _list_get_value(L, I, &v)) { \
         return errno; }                      \
     auto e = _value_get(v, T); free(v);      \
     return errno = e;
 
-#define LIST_DEL_CHECK_IMPL(L, I) \
-    if (!L || L->length <= I) {   \
-        return errno = EINVAL; }  \
+#define LIST_FIND_CHECK_IMPL(L, X, I) \
+    if (!L || !I) {                   \
+        return errno = EINVAL; }      \
+    Value key = { .idx = 0 };         \
+    _value_set(&key, X);              \
+    return _list_find_value(L, &key, I);
+
+#define LIST_VALUE_SET_CHECK_IMPL(V, X) \
+    if (!V) {                         \
+        return errno = EINVAL; }      \
+    _value_set(V, X);                 \
+    return EXIT_SUCCESS;
+
+#define LIST_VALUE_CHECK_IMPL(V, T) \
+    if (!V) {                         \
+        return errno = EINVAL; }      \
+    return errno = _value_get((Value*)V, T);
+
+#define LIST_POP_CHECK_IMPL(L, B, T) \
+    if (!L) {                        \
+        return errno = EINVAL; }     \
+    Value v;                         \
+    char keep[sizeof(Payload)];      \
+    if (_list_pop_value(L, B, &v, keep)) { \
+        return errno; }              \
+    return errno = _value_get(&v, T);
+
+#define LIST_DEL_CHECK_IMPL(L, I)    \
+    if (!L || _list_length(L) <= I) { \
+        return errno = EINVAL; }     \
     return _list_del_value(L, I);
 
+#define LIST_ADD_ARRAY_CHECK_IMPL(L, A, N)    \
+    if (!L || (!A && N > 0)) {                \
+        return errno = EINVAL; }              \
+    if (L->shared) {                          \
+      errno_t e = EXIT_SUCCESS;               \
+      for (size_t k = 0; !e && k < N; k++) {  \
+        Value v = { .idx = IDX_END };         \
+        _value_set(&v, A[k]);                 \
+        e = _shared_add(L, &v); }             \
+      return e; }                             \
+    if (L->map) {                             \
+        return errno = EROFS; }               \
+    if (L->flags & LIST_COMPACT) {            \
+      if (!_list_lock(L)) {                   \
+          return errno = EAGAIN; }            \
+      errno_t e = _store_reserve(L, N) ? EXIT_SUCCESS : (errno = ENOMEM); \
+      size_t k = 0;                           \
+      for (; !e && k < N; k++) {              \
+        Value v;                              \
+        _value_set(&v, A[k]);                 \
+        if (!_journal_insert(L, L->length, &v)) { \
+          e = errno = EIO; break; }           \
+        _store_put(L, L->length, &v);         \
+        _index_insert(L, L->length++, nullptr); } \
+      if (k > 0) {                            \
+        errno_t j = _journal_commit(L);       \
+        e = e ? e : j; }                      \
+      _list_unlock(L);                        \
+      return e; }                             \
+    Value* first = nullptr; Value* last = nullptr;  \
+    for (size_t k = 0; k < N; k++) {          \
+      Value* v = _value_create(L, 0);         \
+      _value_set(v, A[k]);                    \
+      if (last) { last->next = v; }           \
+      else      { first = v; }                \
+      last = v;                               \
+    }                                         \
+    return _list_add_chain(L, first, last, N);
+
+#define LIST_GET_ARRAY_CHECK_IMPL(L, I, N, A)     \
+    if (!L || !A) {                               \
+        return errno = EINVAL; }                  \
+    size_t len = _list_length(L);                 \
+    if (I > len || N > len - I) {                 \
+        return errno = EINVAL; }                  \
+    if (!_list_lock(L)) {                         \
+        return errno = EAGAIN; }                  \
+    errno_t e = EXIT_SUCCESS;                     \
+    if (I > L->length || N > L->length - I) {     \
+      e = EINVAL; }                               \
+    else {                                        \
+      Cursor at;                                  \
+      for (size_t k = 0; k < N; k++)              \
+      { Value* c = k ? _list_step(L, &at)         \
+                     : _list_seek(L, &at, I);     \
+        errno_t r = _value_get(c, &A[k]);         \
+        if (r && !e) { e = r; } }                 \
+    }                                             \
+    _list_unlock(L);                              \
+    return errno = e;
+
+#define LIST_ITER_CHECK_IMPL(IT, T) \
+    if (!IT || !IT->cur) {          \
+        return errno = EINVAL; }    \
+    return errno = _value_get(IT->cur, T);
+
+
+#define VALUE_TEXT_MAX 32  // longest rendered number, "-2.2250738585072014e-308"
+#define FLOAT_FIXED_MAX 400 // "%.6f" of -1e308
+
+ // with "LIST_STRCACHE", each value is followed by its rendered text
+#define _value_cache(V) ((char**)((V) + 1))
 
 PRIVATE
-Value* _value_create(size_t idx)
+Value* _value_create(List* list, size_t idx)
 {
-    auto v = (Value*) calloc(1, sizeof(Value)); // C23
+    size_t size = sizeof(Value);
+    if (list->flags & LIST_STRCACHE) {
+      size += sizeof(char*); }
+
+    auto v = (Value*) calloc(1, size); // C23
     v->idx = idx;
     v->next = nullptr;
 
     return v;
 }
 
+PRIVATE
+Value* _value_dup(List* list, const Value* val)
+{
+    Value* v = _value_create(list, val->idx);
+    memcpy((void*)v, (void*)val, sizeof(Value));
+    v->next = v->prev = nullptr;
+
+    return v;
+}
+
+PRIVATE
+void _value_destroy(List* list, Value* v)
+{
+    if (list->flags & LIST_STRCACHE) {
+      free(*_value_cache(v)); }
+    free(v);
+}
+
+ // values moving to another list must get the layout of their new owner
+PRIVATE
+Value* _value_move(List* from, List* to, Value* v)
+{
+    if (!((from->flags ^ to->flags) & LIST_STRCACHE)) {
+        return v; }
+
+    Value* n = _value_create(to, v->idx);
+    memcpy((void*)n, (void*)v, sizeof(Value));
+    _value_destroy(from, v);
+
+    return n;
+}
+
 #define _value_set(V, T) _Generic((T), \
-    int:    _value_set_int, \
-    bool:   _value_set_bool, \
-    double: _value_set_float, \
-    char*:  _value_set_string)(V, T)
+    int:      _value_set_int, \
+    bool:     _value_set_bool, \
+    double:   _value_set_float, \
+    char*:    _value_set_string, \
+    int64_t:  _value_set_int64, \
+    ListBlob: _value_set_blob)(V, T)
 
 PRIVATE
 void _value_set_int(Value* v, int i)
@@ -148,22 +510,298 @@ void _value_set_string(Value* v, char* s)
     v->s = s;         // C11,C23 (anonymous union)
 }
 
+PRIVATE
+void _value_set_int64(Value* v, int64_t l)
+{
+    v->t = T_INT64;
+    v->l = l;         // C11,C23 (anonymous union)
+}
+
+ // short blobs get copied right away, long ones when the list takes them
+ // (see "_value_own()")
+PRIVATE
+void _value_set_blob(Value* v, ListBlob b)
+{
+    v->t = T_BLOB;
+    v->n = (uint32_t)b.size;
+    if (b.size <= BLOB_INLINE) {
+      memset(v->c, 0, sizeof(v->c));
+      if (b.size) {
+        memcpy(v->c, b.data, b.size); }
+    } else {
+      v->p = (const uint8_t*)b.data;
+    }
+}
+
+// PARSING (locale-independent "atoi()"/"strtod()" for string values)
+
+#define _is_digit(C) ((unsigned)((C) - '0') < 10)
+#define _is_space(C) ((C) == ' ' || (unsigned)((C) - '\t') < 5)  // \t\n\v\f\r
+
+ // 8 ASCII digits at once, as a little-endian 64-bit word (SWAR)
+PRIVATE
+bool _swar_is_digits(uint64_t w)
+{
+    return !(((w + 0x4646464646464646) | (w - 0x3030303030303030)) & 0x8080808080808080);
+}
+
+ // ...their value: digit pairs, then quads, then all 8
+PRIVATE
+uint32_t _swar_digits(uint64_t w)
+{
+    const uint64_t mask = 0x000000FF000000FF;
+    w -= 0x3030303030303030;
+    w = (w * 10) + (w >> 8);
+    w = (((w & mask) * 0x000F424000000064) + (((w >> 16) & mask) * 0x0000271000000001)) >> 32;
+    return (uint32_t)w;
+}
+
+ // appends the digits from "p" (up to "end") to "*u", 8 at a time while
+ // possible; returns past them ("*u" wraps beyond 19, callers count)
+PRIVATE
+const char* _parse_digits(const char* p, const char* end, uint64_t* u)
+{
+    uint64_t x = *u;
+
+    while (end - p >= 8) {
+      uint64_t w = 0;
+      for (int b = 0; b < 8; b++) {
+        w |= (uint64_t)(uint8_t)p[b] << (8 * b); }
+      if (!_swar_is_digits(w)) {
+          break; }
+      x = x * 100000000 + _swar_digits(w);
+      p += 8;
+    }
+    for (; p < end && _is_digit(*p); p++) {
+      x = x * 10 + (uint64_t)(*p - '0'); }
+
+    *u = x;
+    return p;
+}
+
+ // "strtoll(s, nullptr, 10)": saturates the same way
+PRIVATE
+int64_t _parse_int64(const char* s)
+{
+    const char* end = s + strlen(s);
+    const char* p = s;
+    bool neg = false;
+    uint64_t u = 0;
+
+    while (p < end && _is_space(*p)) {
+      p++; }
+    if (p < end && (*p == '-' || *p == '+')) {
+      neg = (*p++ == '-'); }
+    while (p < end && *p == '0') {
+      p++; }
+
+    const char* digits = p;
+    p = _parse_digits(p, end, &u);
+    if (p - digits > 19 || u > (uint64_t)INT64_MAX + neg) {
+        return neg ? INT64_MIN : INT64_MAX; }
+
+    return neg ? (int64_t)(0 - u) : (int64_t)u;
+}
+
+typedef struct
+{
+    uint64_t m;           // significant digits, without leading zeros
+    int e;                // times 10^e
+    bool neg;
+    bool many;            // more than 19 of them: "m" is not exact
+    bool integral;        // neither fraction nor exponent
+} Number;
+
+ // decimal number at "s": spaces, sign, digits, fraction, exponent (no hex,
+ // "inf" or "nan"); returns past it, or "s" if there is none
+PRIVATE
+const char* _parse_number(const char* s, const char* end, Number* n)
+{
+    const char* p = s;
+    size_t count = 0;
+    bool seen = false;
+
+    *n = (Number){ .integral = true };
+    while (p < end && _is_space(*p)) {
+      p++; }
+    if (p < end && (*p == '-' || *p == '+')) {
+      n->neg = (*p++ == '-'); }
+
+    const char* q = p;
+    while (p < end && *p == '0') {
+      p++; }
+    seen = (p > q);
+    q = p;
+    p = _parse_digits(p, end, &n->m);
+    count = p - q;
+    seen |= (count > 0);
+
+    if (p < end && *p == '.') {
+      const char* frac = ++p;
+      while (count == 0 && p < end && *p == '0') {
+        p++; }
+      q = p;
+      p = _parse_digits(p, end, &n->m);
+      count += p - q;
+      n->e -= (int)(p - frac);
+      n->integral = false;
+      seen |= (p > frac);
+    }
+    if (!seen) {
+        return s; }
+
+    if (p < end && (*p == 'e' || *p == 'E')) {
+      q = p + 1;
+      bool neg = false;
+      if (q < end && (*q == '-' || *q == '+')) {
+        neg = (*q++ == '-'); }
+      if (q < end && _is_digit(*q)) {
+        int x = 0;
+        for (; q < end && _is_digit(*q); q++) {
+          x = (x < 100000) ? x * 10 + (*q - '0') : x; }
+        n->e += neg ? -x : x;
+        n->integral = false;
+        p = q;
+      }
+    }
+
+    n->many = (count > 19);
+    return p;
+}
+
+static const double _pow10[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+ // exact when both the digits and 10^e fit a double, one rounding then
+ // (Clinger's fast path); false means "ask strtod()"
+PRIVATE
+bool _number_float(const Number* n, double* f)
+{
+    if (n->m == 0 && !n->many) {
+      *f = n->neg ? -0.0 : 0.0;
+      return true; }
+    if (FLT_EVAL_METHOD != 0 || n->many || n->m > ((uint64_t)1 << 53)
+        || n->e < -22 || n->e > 22) {
+        return false; }
+
+    double x = (double)n->m;
+    x = (n->e < 0) ? x / _pow10[-n->e] : x * _pow10[n->e];
+    *f = n->neg ? -x : x;
+    return true;
+}
+
+static once_flag _c_locale_once = ONCE_FLAG_INIT;
+#ifdef _WIN32
+static _locale_t _c_locale;
+#  define _strtod_c(S) _strtod_l(S, nullptr, _c_locale)
+#else
+static locale_t _c_locale;
+#  define _strtod_c(S) strtod_l(S, nullptr, _c_locale)
+#endif
+
+PRIVATE
+void _c_locale_create(void)
+{
+#ifdef _WIN32
+    _c_locale = _create_locale(LC_NUMERIC, "C");
+#else
+    _c_locale = newlocale(LC_NUMERIC_MASK, "C", (locale_t)0);
+#endif
+}
+
+ // "snprintf()", with a '.' whatever "setlocale()" says
+PRIVATE
+int _snprintf_c(char* buf, size_t len, const char* fmt, ...)
+{
+    call_once(&_c_locale_once, _c_locale_create);
+
+    va_list ap;
+    va_start(ap, fmt);
+#ifdef _WIN32
+    int n = _c_locale ? _vsnprintf_l(buf, len, fmt, _c_locale, ap) : vsnprintf(buf, len, fmt, ap);
+#else
+    locale_t was = _c_locale ? uselocale(_c_locale) : (locale_t)0;
+    int n = vsnprintf(buf, len, fmt, ap);
+    if (was) {
+      uselocale(was); }
+#endif
+    va_end(ap);
+
+    return n;
+}
+
+ // "strtod(s, nullptr)", with a '.' whatever "setlocale()" says
+PRIVATE
+double _parse_float(const char* s)
+{
+    const char* end = s + strlen(s);
+    Number n;
+    double f;
+
+    const char* p = _parse_number(s, end, &n);
+    if (p > s && !(p < end && (*p == 'x' || *p == 'X')) && _number_float(&n, &f)) {
+        return f; }
+
+    // hex, "inf", "nan", long or far-off digits: rare enough
+    call_once(&_c_locale_once, _c_locale_create);
+    return _c_locale ? _strtod_c(s) : strtod(s, nullptr);
+}
+
+ // "list_parse_numeric()": whole numbers to ints (int64s past INT_MAX),
+ // other numbers to floats; strings that are not just a number stay
+PRIVATE
+void _value_parse_numeric(Value* v, size_t idx, void* ctx)
+{
+    (void)idx; (void)ctx;
+    if (v->t != T_STRING || !v->s) {
+        return; }
+
+    const char* end = v->s + strlen(v->s);
+    Number n;
+    const char* p = _parse_number(v->s, end, &n);
+    if (p == v->s) {
+        return; }
+    while (p < end && _is_space(*p)) {
+      p++; }
+    if (p != end) {
+        return; }
+
+    if (n.integral && !n.many && n.m <= (uint64_t)INT64_MAX + n.neg) {
+      int64_t l = n.neg ? (int64_t)(0 - n.m) : (int64_t)n.m;
+      if (l >= INT_MIN && l <= INT_MAX) {
+        _value_set(v, (int)l);
+      } else {
+        _value_set(v, l); }
+      return;
+    }
+
+    double f;
+    if (!_number_float(&n, &f)) {
+      f = _parse_float(v->s); }
+    _value_set(v, f);
+}
+
 #define _value_get(V, T) _Generic((T), \
-    int*:    _value_get_int, \
-    bool*:   _value_get_bool, \
-    double*: _value_get_float, \
-    char**:  _value_get_string, \
-    void*:   _value_get_Type)(V, T)
+    int*:      _value_get_int, \
+    bool*:     _value_get_bool, \
+    double*:   _value_get_float, \
+    char**:    _value_get_string, \
+    int64_t*:  _value_get_int64, \
+    ListBlob*: _value_get_blob, \
+    void*:     _value_get_Type)(V, T)
 
 PRIVATE
 errno_t _value_get_int(Value* v, int* i)
 {
     switch (v->t) {
-      case T_INTEGER: *i = v->i;              break;
-      case T_BOOLEAN: *i = v->b;              return EBOOLEAN;
-      case T_FLOAT  : *i = (int)lround(v->f); return EFLOAT;
-      case T_STRING : *i = atoi(v->s);        return ESTRING;
-      default       :                         return EUNDEF;
+      case T_INTEGER: *i = v->i;                    break;
+      case T_BOOLEAN: *i = v->b;                    return EBOOLEAN;
+      case T_FLOAT  : *i = (int)lround(v->f);       return EFLOAT;
+      case T_STRING : *i = (int)_parse_int64(v->s); return ESTRING;
+      case T_INT64  : *i = (int)v->l;               return EINT64;
+      case T_BLOB   : *i = 0;                       return EBLOB;
+      default       :                               return EUNDEF;
     }
     return EXIT_SUCCESS;
 }
@@ -176,6 +814,8 @@ errno_t _value_get_bool(Value* v, bool* b)
       case T_BOOLEAN: *b = v->b;                 break;
       case T_FLOAT  : *b = (int)v->f?true:false; return EFLOAT;
       case T_STRING : *b = !strcmp(v->s,"true"); return ESTRING;
+      case T_INT64  : *b = v->l?true:false;      return EINT64;
+      case T_BLOB   : *b = v->n?true:false;      return EBLOB;
       default       :                            return EUNDEF;
     }
     return EXIT_SUCCESS;
@@ -185,11 +825,13 @@ PRIVATE
 errno_t _value_get_float(Value* v, double* f)
 {
     switch (v->t) {
-      case T_INTEGER: *f = v->i;                  return EINTEGER;
-      case T_BOOLEAN: *f = v->b;                  return EBOOLEAN;
-      case T_FLOAT  : *f = v->f;                  break;
-      case T_STRING : *f = strtod(v->s, nullptr); return ESTRING;
-      default       :                             return EUNDEF;
+      case T_INTEGER: *f = v->i;               return EINTEGER;
+      case T_BOOLEAN: *f = v->b;               return EBOOLEAN;
+      case T_FLOAT  : *f = v->f;               break;
+      case T_STRING : *f = _parse_float(v->s); return ESTRING;
+      case T_INT64  : *f = (double)v->l;       return EINT64;
+      case T_BLOB   : *f = 0.0;                return EBLOB;
+      default       :                          return EUNDEF;
     }
     return EXIT_SUCCESS;
 }
@@ -200,8 +842,12 @@ errno_t _value_get_string(Value* v, char** s)
     switch (v->t) {
       case T_INTEGER: asprintf(s,"%d",v->i);   return EINTEGER;
       case T_BOOLEAN: asprintf(s,"%s",v->b?"true":"false"); return EBOOLEAN;
-      case T_FLOAT  : asprintf(s,"%.6f",v->f); return EFLOAT;
+      case T_FLOAT  : { char t[FLOAT_FIXED_MAX];
+                        _snprintf_c(t, sizeof(t), "%.6f", v->f);
+                        *s = strdup(t); }      return EFLOAT;
       case T_STRING : *s = v->s;               break;
+      case T_INT64  : asprintf(s,"%" PRId64,v->l); return EINT64;
+      case T_BLOB   : asprintf(s,"%.*s",(int)v->n,(const char*)_value_bytes(v)); return EBLOB;
       default       :                          return EUNDEF;
     }
     return EXIT_SUCCESS;
@@ -215,180 +861,4793 @@ errno_t _value_get_Type(Value* v, void*)
       case T_BOOLEAN: return EBOOLEAN;
       case T_FLOAT  : return EFLOAT;
       case T_STRING : return ESTRING;
+      case T_INT64  : return EINT64;
+      case T_BLOB   : return EBLOB;
       default       : return EUNDEF;
     }
 }
 
 PRIVATE
-void _value_dump(Value* v)
+errno_t _value_get_int64(Value* v, int64_t* l)
 {
     switch (v->t) {
-      case T_INTEGER: printf("%d",   v->i);                 break;
-      case T_BOOLEAN: printf("%s",   v->b ?"true":"false"); break;
-      case T_FLOAT  : printf("%.6f", v->f);                 break;
-      case T_STRING : printf("%s",   v->s);                 break;
-      default       : fprintf(stderr, "Unknown value type");
+      case T_INTEGER: *l = v->i;                    return EINTEGER;
+      case T_BOOLEAN: *l = v->b;                    return EBOOLEAN;
+      case T_FLOAT  : *l = llround(v->f);           return EFLOAT;
+      case T_STRING : *l = _parse_int64(v->s);      return ESTRING;
+      case T_INT64  : *l = v->l;                    break;
+      case T_BLOB   : *l = 0;                       return EBLOB;
+      default       :                               return EUNDEF;
     }
+    return EXIT_SUCCESS;
 }
 
+ // points to the bytes in "v" (strings: their text), nothing for numbers
 PRIVATE
-bool _list_lock(List* list)
+errno_t _value_get_blob(Value* v, ListBlob* b)
 {
-    struct timespec ts;                 // C11,C23
-    timespec_get(&ts, TIME_UTC);
-    ts.tv_nsec += list->timeout * 1000;
+    b->data = nullptr;
+    b->size = 0;
 
-    return (mtx_timedlock(&list->locked, &ts) == thrd_success);
+    switch (v->t) {
+      case T_BLOB   : b->data = _value_bytes(v); b->size = v->n; break;
+      case T_STRING : b->data = v->s; b->size = v->s ? strlen(v->s) : 0;
+                      return ESTRING;
+      default       : return _value_get_Type(v, nullptr);
+    }
+    return EXIT_SUCCESS;
 }
 
+static const char _digits[] =
+    "00010203040506070809" "10111213141516171819" "20212223242526272829"
+    "30313233343536373839" "40414243444546474849" "50515253545556575859"
+    "60616263646566676869" "70717273747576777879" "80818283848586878889"
+    "90919293949596979899";
+
 PRIVATE
-errno_t _list_add_value(List* list, Value* val)
+size_t _format_uint(char* buf, uint64_t u)
 {
-    if (!_list_lock(list))
-    {   free(val);
-        return errno = EAGAIN; }
+    char tmp[20];
+    char* p = tmp + sizeof(tmp);
 
-    if (val->idx == list->length)
-    { switch (list->last == nullptr) {
-        case true:  list->first = val; break;
-        case false: list->last->next = val;
-      }
-      list->last = val;
+    // two digits at a time, right to left
+    while (u >= 100) {
+      p -= 2; memcpy(p, &_digits[(u % 100) * 2], 2);
+      u /= 100;
+    }
+    if (u >= 10) {
+      p -= 2; memcpy(p, &_digits[u * 2], 2);
     } else {
-      Value* c = list->first;
-      for (typeof(val->idx) i = 0; i < val->idx - 1; i++) { // C23
-        c = c->next; }
-      // emplace our value
-      Value* n = c->next;
-      c->next = val;
-      val->next = n;
-      // re-index following ones
-      while (n != nullptr) {
-        n->idx++;
-        n = n->next;
-      }
+      *--p = '0' + (char)u;
     }
 
-    list->length++;
-    mtx_unlock(&list->locked);
-
-    return EXIT_SUCCESS;
+    size_t len = tmp + sizeof(tmp) - p;
+    memcpy(buf, p, len);
+    return len;
 }
 
 PRIVATE
-errno_t _list_del_value(List* list, size_t idx)
+size_t _format_int(char* buf, int64_t i)
 {
-    if (!_list_lock(list)) {
-        return errno = EAGAIN; }
-
-    Value* c = list->first;
-    for (int i = 0; i < ((int)idx - 1); i++) {
-      c = c->next; }
-    // this is the target
-    Value* n = (idx == 0) ? c : c->next;
-    if (idx == 0) {
-      list->first = c->next;
-    } else if (idx == list->length -1) {
-      list->last = c;
-      c->next = nullptr;
-    } else {
-      c->next = n->next;
-    }
-    c = n->next;
-    free(n);
-    // re-index following ones
-    while (c != nullptr) {
-      c->idx--;
-      c = c->next;
+    if (i < 0) {
+      *buf = '-';
+      return 1 + _format_uint(buf + 1, (uint64_t)0 - (uint64_t)i);
     }
+    return _format_uint(buf, (uint64_t)i);
+}
 
-    list->length--;
-    mtx_unlock(&list->locked);
+ // shortest round-trip digits of a double: Ryu (Ulf Adams, PLDI 2018); the
+ // tables hold 5^i and 2^k/5^q, 125-bit, as { low, high } words
+#define POW5_INV_BITS 125
+#define POW5_BITS     125
 
-    return EXIT_SUCCESS;
+static const uint64_t _pow5_inv[291][2] = {   // 2^(bits(5^q) + 124) / 5^q, + 1
+    { 0x0000000000000001u, 0x2000000000000000u }, { 0x999999999999999au, 0x1999999999999999u },
+    { 0x47ae147ae147ae15u, 0x147ae147ae147ae1u }, { 0x6c8b4395810624deu, 0x10624dd2f1a9fbe7u },
+    { 0x7a786c226809d496u, 0x1a36e2eb1c432ca5u }, { 0x61f9f01b866e43abu, 0x14f8b588e368f084u },
+    { 0xb4c7f34938583622u, 0x10c6f7a0b5ed8d36u }, { 0x87a6520ec08d236au, 0x1ad7f29abcaf4857u },
+    { 0x9fb841a566d74f88u, 0x15798ee2308c39dfu }, { 0xe62d01511f12a607u, 0x112e0be826d694b2u },
+    { 0xd6ae6881cb5109a4u, 0x1b7cdfd9d7bdbab7u }, { 0xdef1ed34a2a73aeau, 0x15fd7fe17964955fu },
+    { 0x7f27f0f6e885c8bbu, 0x119799812dea1119u }, { 0x650cb4be40d60df8u, 0x1c25c268497681c2u },
+    { 0xea70909833de7193u, 0x16849b86a12b9b01u }, { 0x21f3a6e0297ec143u, 0x1203af9ee756159bu },
+    { 0x6985d7cd0f313537u, 0x1cd2b297d889bc2bu }, { 0x2137dfd73f5a90f9u, 0x170ef54646d49689u },
+    { 0xe75fe645cc4873fau, 0x12725dd1d243aba0u }, { 0xa5663d3c7a0d865du, 0x1d83c94fb6d2ac34u },
+    { 0x511e976394d79eb1u, 0x179ca10c9242235du }, { 0xda7edf82dd794bc1u, 0x12e3b40a0e9b4f7du },
+    { 0x2a6498d1625bac68u, 0x1e392010175ee596u }, { 0xeeb6e0a781e2f053u, 0x182db34012b25144u },
+    { 0x58924d52ce4f26a9u, 0x1357c299a88ea76au }, { 0x27507bb7b07ea441u, 0x1ef2d0f5da7dd8aau },
+    { 0x52a6c95fc0655034u, 0x18c240c4aecb13bbu }, { 0x0eebd44c99eaa690u, 0x13ce9a36f23c0fc9u },
+    { 0xb17953adc3110a80u, 0x1fb0f6be50601941u }, { 0xc12ddc8b02740867u, 0x195a5efea6b34767u },
+    { 0x3424b06f3529a052u, 0x14484bfeebc29f86u }, { 0x901d59f290ee19dbu, 0x1039d66589687f9eu },
+    { 0x4cfbc31db4b0295fu, 0x19f623d5a8a73297u }, { 0x3d9635b15d59bab2u, 0x14c4e977ba1f5bacu },
+    { 0x97ab5e277de16228u, 0x109d8792fb4c4956u }, { 0xf2abc9d8c9689d0du, 0x1a95a5b7f87a0ef0u },
+    { 0x5bbca17a3aba173eu, 0x154484932d2e725au }, { 0xafca1ac82efb45cbu, 0x11039d428a8b8eaeu },
+    { 0xb2dcf7a6b1920945u, 0x1b38fb9daa78e44au }, { 0xf57d92ebc141a104u, 0x15c72fb1552d836eu },
+    { 0xc46475896767b403u, 0x116c262777579c58u }, { 0x6d6d88dbd8a5ecd2u, 0x1be03d0bf225c6f4u },
+    { 0x8abe071646eb23dbu, 0x164cfda3281e38c3u }, { 0x6efe6c11d255b649u, 0x11d7314f534b609cu },
+    { 0xb197134fb6ef8a0eu, 0x1c8b821885456760u }, { 0x27ac0f72f8bfa1a5u, 0x16d601ad376ab91au },
+    { 0xb95672c260994e1eu, 0x1244ce242c5560e1u }, { 0xf5571e03cdc21695u, 0x1d3ae36d13bbce35u },
+    { 0x2aac18030b01ababu, 0x17624f8a762fd82bu }, { 0xbbbce0026f348956u, 0x12b50c6ec4f31355u },
+    { 0x92c7ccd0b1eda889u, 0x1dee7a4ad4b81eefu }, { 0xdbd30a408e57ba07u, 0x17f1fb6f10934bf2u },
+    { 0x7ca8d50071dfc806u, 0x1327fc58da0f6ff5u }, { 0xfaa7bb33e9660cd6u, 0x1ea6608e29b24cbbu },
+    { 0x9552fc298784d711u, 0x18851a0b548ea3c9u }, { 0xaaa8c9bad2d0ac0eu, 0x139dae6f76d88307u },
+    { 0xdddadc5e1e1aace3u, 0x1f62b0b257c0d1a5u }, { 0x7e48b04b4b488a4fu, 0x191bc08eac9a4151u },
+    { 0xcb6d59d5d5d3a1d9u, 0x141633a556e1cddau }, { 0x3c577b1177dc817bu, 0x1011c2eaabe7d7e2u },
+    { 0xc6f25e825960cf2au, 0x19b604aaaca62636u }, { 0x6bf518684780a5bbu, 0x14919d5556eb51c5u },
+    { 0x232a79ed06008496u, 0x10747ddddf22a7d1u }, { 0xd1dd8fe1a3340756u, 0x1a53fc9631d10c81u },
+    { 0xa7e4731ae8f66c45u, 0x150ffd44f4a73d34u }, { 0x531d28e253f8569eu, 0x10d9976a5d52975du },
+    { 0xeb61db03b98d5762u, 0x1af5bf109550f22eu }, { 0xbc4e48cfc7a445e8u, 0x159165a6ddda5b58u },
+    { 0x6371d3d96c836b20u, 0x11411e1f17e1e2adu }, { 0x9f1c8628ad9f11cdu, 0x1b9b6364f3030448u },
+    { 0xe5b06b53be18db0bu, 0x1615e91d8f359d06u }, { 0xeaf3890fcb4715a2u, 0x11ab20e472914a6bu },
+    { 0x44b8db4c7871bc37u, 0x1c45016d841baa46u }, { 0x03c715d6c6c1635fu, 0x169d9abe03495505u },
+    { 0x3638de456bcde919u, 0x1217aefe69077737u }, { 0x56c163a2461641c1u, 0x1cf2b1970e725858u },
+    { 0xdf011c81d1ab67ceu, 0x17288e1271f51379u }, { 0x7f3416ce4155eca5u, 0x1286d80ec190dc61u },
+    { 0x6520247d3556476eu, 0x1da48ce468e7c702u }, { 0xea801d30f7783925u, 0x17b6d71d20b96c01u },
+    { 0xbb99b0f3f92cfa84u, 0x12f8ac174d612334u }, { 0x5f5c4e532847f739u, 0x1e5aacf215683854u },
+    { 0x7f7d0b75b9d32c2eu, 0x18488a5b44536043u }, { 0x9930d5f7c7dc2358u, 0x136d3b7c36a919cfu },
+    { 0x8eb4898c72f9d226u, 0x1f152bf9f10e8fb2u }, { 0x722a07a38f2e41b8u, 0x18ddbcc7f40ba628u },
+    { 0xc1bb394fa5be9afau, 0x13e497065cd61e86u }, { 0x9c5ec2190930f7f6u, 0x1fd424d6faf030d7u },
+    { 0x49e56814075a5ff8u, 0x197683df2f268d79u }, { 0x6e51201005e1e660u, 0x145ecfe5bf520ac7u },
+    { 0xf1da800cd181851au, 0x104bd984990e6f05u }, { 0x4fc400148268d4f5u, 0x1a12f5a0f4e3e4d6u },
+    { 0xd96999aa01ed772bu, 0x14dbf7b3f71cb711u }, { 0xadee1488018ac5bcu, 0x10aff95cc5b09274u },
+    { 0x497ceda668de092cu, 0x1ab328946f80ea54u }, { 0x3aca57b853e4d424u, 0x155c2076bf9a5510u },
+    { 0x623b7960431d7683u, 0x1116805effaeaa73u }, { 0x9d2bf566d1c8bd9eu, 0x1b5733cb32b110b8u },
+    { 0x7dbcc452416d647fu, 0x15df5ca28ef40d60u }, { 0xcafd69db678ab6ccu, 0x117f7d4ed8c33de6u },
+    { 0xab2f0fc572778adfu, 0x1bff2ee48e052fd7u }, { 0x88f273045b92d580u, 0x1665bf1d3e6a8cacu },
+    { 0xd3f528d049424466u, 0x11eaff4a98553d56u }, { 0xb988414d4203a0a3u, 0x1cab3210f3bb9557u },
+    { 0x6139cdd76802e6e9u, 0x16ef5b40c2fc7779u }, { 0xe761717920025254u, 0x125915cd68c9f92du },
+    { 0xa568b58e999d5086u, 0x1d5b561574765b7cu }, { 0x5120913ee14aa6d2u, 0x177c44ddf6c515fdu },
+    { 0xa74d40ff1aa21f0eu, 0x12c9d0b1923744cau }, { 0x0baece64f769cb4au, 0x1e0fb44f50586e11u },
+    { 0x3c8bd850c5ee3c3bu, 0x180c903f7379f1a7u }, { 0xca0979da37f1c9c9u, 0x133d4032c2c7f485u },
+    { 0xa9a8c2f6bfe942dbu, 0x1ec866b79e0cba6fu }, { 0x2153cf2bccba9be3u, 0x18a0522c7e709526u },
+    { 0x1aa9728970954982u, 0x13b374f06526ddb8u }, { 0xf775840f1a88759du, 0x1f8587e7083e2f8cu },
+    { 0x5f9136727ba05e17u, 0x19379fec0698260au }, { 0x1940f85b9619e4dfu, 0x142c7ff0054684d5u },
+    { 0xe100c6afab47ea4cu, 0x1023998cd1053710u }, { 0xce67a44c453fdd47u, 0x19d28f47b4d524e7u },
+    { 0xd852e9d69dccb106u, 0x14a8729fc3ddb71fu }, { 0x79dbee454b0a2738u, 0x1086c219697e2c19u },
+    { 0x295fe3a211a9d859u, 0x1a71368f0f30468fu }, { 0xbab31c81a7bb137au, 0x15275ed8d8f36ba5u },
+    { 0x6228e39aec95a92fu, 0x10ec4be0ad8f8951u }, { 0x9d0e38f7e0ef7517u, 0x1b13ac9aaf4c0ee8u },
+    { 0xb0d82d931a592a79u, 0x15a956e225d67253u }, { 0x8d79be0f4847552eu, 0x11544581b7dec1dcu },
+    { 0x158f967eda0bbb7cu, 0x1bba08cf8c979c94u }, { 0x77a611ff14d62f97u, 0x162e6d72d6dfb076u },
+    { 0xf951a7ff43de8c79u, 0x11bebdf578b2f391u }, { 0xc21c3ffed2fdad8eu, 0x1c6463225ab7ec1cu },
+    { 0x01b0333242648ad8u, 0x16b6b5b5155ff017u }, { 0x0159c28e9b83a246u, 0x122bc490dde659acu },
+    { 0xcef604175f3903a3u, 0x1d12d41afca3c2acu }, { 0x725e69ac4c2d9c83u, 0x17424348ca1c9bbdu },
+    { 0xf5185489d68ae39cu, 0x129b69070816e2fdu }, { 0xee8d540fbdab05c6u, 0x1dc574d80cf16b2fu },
+    { 0xbed77672fe226b05u, 0x17d12a4670c1228cu }, { 0xff12c528cb4ebc04u, 0x130dbb6b8d674ed6u },
+    { 0xcb513b74787df9a0u, 0x1e7c5f127bd87e24u }, { 0x090dc929f9fe614du, 0x18637f41fcad31b7u },
+    { 0xa0d7d42194cb810au, 0x1382cc34ca2427c5u }, { 0x67bfb9cf5478ce77u, 0x1f37ad21436d0c6fu },
+    { 0x1fcc94a5dd2d71f9u, 0x18f9574dcf8a7059u }, { 0x7fd6dd517dbdf4c7u, 0x13faac3e3fa1f37au },
+    { 0xffbe2ee8c92fee0bu, 0x1ff779fd329cb8c3u }, { 0x6631bf20a0f324d6u, 0x1992c7fdc216fa36u },
+    { 0xb827cc1a1a5c1d78u, 0x14756ccb01abfb5eu }, { 0x935309ae7b7ce460u, 0x105df0a267bcc918u },
+    { 0x1eeb42b0c594a099u, 0x1a2fe76a3f9474f4u }, { 0xe58902270476e6e1u, 0x14f31f8832dd2a5cu },
+    { 0xb7a0ce859d2bebe7u, 0x10c27fa028b0eeb0u }, { 0x59014a6f61dfdfd8u, 0x1ad0cc33744e4ab4u },
+    { 0xe0cdd525e7e64cadu, 0x1573d68f903ea229u }, { 0x4d7177518651d6f1u, 0x11297872d9cbb4eeu },
+    { 0x7be8bee8d6e957e8u, 0x1b758d848fac54b0u }, { 0xfcba3253df211320u, 0x15f7a46a0c89dd59u },
+    { 0x63c8284318e74280u, 0x1192e9ee706e4aaeu }, { 0x060d0d3827d86a66u, 0x1c1e43171a4a1117u },
+    { 0x6b3da42cecad21ebu, 0x167e9c127b6e7412u }, { 0x88fe1cf0bd574e56u, 0x11fee341fc585cdbu },
+    { 0x419694b462254a23u, 0x1ccb0536608d615fu }, { 0x67abaa29e81dd4e9u, 0x1708d0f84d3de77fu },
+    { 0xb95621bb2017dd87u, 0x126d73f9d764b932u }, { 0xc223692b668c95a5u, 0x1d7becc2f23ac1eau },
+    { 0xce82ba891ed6de1du, 0x179657025b6234bbu }, { 0xa53562074bdf1818u, 0x12deac01e2b4f6fcu },
+    { 0x3b889cd87964f359u, 0x1e3113363787f194u }, { 0xfc6d4a46c783f5e1u, 0x18274291c6065adcu },
+    { 0x30576e9f06032b1au, 0x13529ba7d19eaf17u }, { 0x1a257dcb3cd1de90u, 0x1eea92a61c311825u },
+    { 0x481dfe3c30a7e540u, 0x18bba884e35a79b7u }, { 0xd34b31c9c0865100u, 0x13c9539d82aec7c5u },
+    { 0x5211e942cda3b4cdu, 0x1fa885c8d117a609u }, { 0x74db21023e1c90a4u, 0x19539e3a40dfb807u },
+    { 0xf715b401cb4a0d50u, 0x1442e4fb67196005u }, { 0xf8de299b09080aa7u, 0x103583fc527ab337u },
+    { 0x8e304291a80cddd7u, 0x19ef3993b72ab859u }, { 0x3e8d020e200a4b13u, 0x14bf6142f8eef9e1u },
+    { 0x653d9b3e80083c0fu, 0x10991a9bfa58c7e7u }, { 0x6ec8f864000d2ce4u, 0x1a8e90f9908e0ca5u },
+    { 0x8bd3f9e999a423eau, 0x153eda614071a3b7u }, { 0x3ca994bae1501cbbu, 0x10ff151a99f482f9u },
+    { 0xc775bac49bb3612bu, 0x1b31bb5dc320d18eu }, { 0xd2c4956a16291a89u, 0x15c162b168e70e0bu },
+    { 0xdbd0778811ba7ba1u, 0x11678227871f3e6fu }, { 0x2c80bf401c5d929bu, 0x1bd8d03f3e9863e6u },
+    { 0xbd33cc3349e47549u, 0x16470cff6546b651u }, { 0xca8fd68f6e505dd4u, 0x11d270cc51055ea7u },
+    { 0x4419574be3b3c953u, 0x1c83e7ad4e6efdd9u }, { 0x0347790982f63aa9u, 0x16cfec8aa52597e1u },
+    { 0xcf6c60d468c4fbbau, 0x123ff06eea847980u }, { 0xe57a34870e07f92au, 0x1d331a4b10d3f59au },
+    { 0x512e906c0b399422u, 0x175c1508da432ae2u }, { 0xda8ba6bcd5c7a9b5u, 0x12b010d3e1cf5581u },
+    { 0x90df712e22d90f87u, 0x1de6815302e5559cu }, { 0xda4c5a8b4f140c6cu, 0x17eb9aa8cf1dde16u },
+    { 0xaea37ba2a5a9a38au, 0x1322e220a5b17e78u }, { 0x7dd25f6aa2a905a9u, 0x1e9e369aa2b59727u },
+    { 0x97db7f888220d154u, 0x187e92154ef7ac1fu }, { 0x797c6606ce80a777u, 0x139874ddd8c6234cu },
+    { 0x8f2d700ae4010bf1u, 0x1f5a549627a36badu }, { 0x0c2459a25000d65au, 0x191510781fb5efbeu },
+    { 0x701d1481d99a4515u, 0x1410d9f9b2f7f2feu }, { 0xc017439b147b6a77u, 0x100d7b2e28c65bfeu },
+    { 0xccf205c4ed9243f2u, 0x19af2b7d0e0a2ccau }, { 0x0a5b37d0be0e9cc2u, 0x148c22ca71a1bd6fu },
+    { 0x0848f973cb3ee3ceu, 0x10701bd527b4978cu }, { 0xda0e5bec78649fb0u, 0x1a4cf9550c5425acu },
+    { 0x7b3eaff060507fc0u, 0x150a6110d6a9b7bdu }, { 0x95cbbff380406633u, 0x10d51a73deee2c97u },
+    { 0xefac665266cd7052u, 0x1aee90b964b04758u }, { 0x2623850eb8a459dbu, 0x158ba6fab6f36c47u },
+    { 0x1e82d0d893b6ae49u, 0x113c85955f29236cu }, { 0xfd9e1af41f8ab075u, 0x1b9408eefea838acu },
+    { 0x97b1af29b2d559f7u, 0x16100725988693bdu }, { 0xac8e25baf5777b2cu, 0x11a66c1e139edc97u },
+    { 0x7a7d092b2258c513u, 0x1c3d79c9b8fe2dbfu }, { 0x61fda0ef4ead6a76u, 0x169794a160cb57ccu },
+    { 0xe7fe1a590bbdeec5u, 0x1212dd4de7091309u }, { 0xa6635d5b45fcb13au, 0x1ceafbafd80e84dcu },
+    { 0x851c4aaf6b308dc8u, 0x172262f3133ed0b0u }, { 0xd0e36ef2bc26d7d4u, 0x1281e8c275cbda26u },
+    { 0xb49f17eac6a48c86u, 0x1d9ca79d894629d7u }, { 0x2a18dfef0550706bu, 0x17b08617a104ee46u },
+    { 0x54e0b3259dd9f389u, 0x12f39e794d9d8b6bu }, { 0x87cdeb6f62f65274u, 0x1e5297287c2f4578u },
+    { 0xd30b22bf825ea85du, 0x18421286c9bf6ac6u }, { 0x0f3c1bcc684bb9e4u, 0x13680ed23aff889fu },
+    { 0x18602c7a4079296du, 0x1f0ce4839198da98u }, { 0x46b356c833942124u, 0x18d71d360e13e213u },
+    { 0x388f78a029434db6u, 0x13df4a91a4dcb4dcu }, { 0x5a7f2766a86baf8au, 0x1fcbaa82a1612160u },
+    { 0x153285ebb9efbfa2u, 0x196fbb9bb44db44du }, { 0xaa8ed189618c994eu, 0x145962e2f6a4903du },
+    { 0xeed8a7a11ad6e10cu, 0x1047824f2bb6d9cau }, { 0x7e27729b5e249b45u, 0x1a0c03b1df8af611u },
+    { 0xfe85f549181d4904u, 0x14d6695b193bf80du }, { 0xcb9e5dd4134aa0d0u, 0x10ab877c142ff9a4u },
+    { 0xdf63c9535211014du, 0x1aac0bf9b9e65c3au }, { 0x191ca10f74da6771u, 0x15566ffafb1eb02fu },
+    { 0xadb080d92a4852c1u, 0x1111f32f2f4bc025u }, { 0x15e7348eaa0d5134u, 0x1b4feb7eb212cd09u },
+    { 0xab1f5d3eee710dc4u, 0x15d98932280f0a6du }, { 0xbc1917658b8da49du, 0x117ad428200c0857u },
+    { 0x2cf4f23c127c3a94u, 0x1bf7b9d9cce00d59u }, { 0xf0c3f4fcdb969543u, 0x165fc7e170b33de0u },
+    { 0x5a365d9716121103u, 0x11e6398126f5cb1au }, { 0x9056fc24f01ce804u, 0x1ca38f350b22de90u },
+    { 0xd9df301d8ce3ecd0u, 0x16e93f5da2824ba6u }, { 0xe17f59b13d8323dau, 0x125432b14ecea2ebu },
+    { 0x68cbc2b52f38395cu, 0x1d53844ee47dd179u }, { 0x53d6355dbf602de3u, 0x177603725064a794u },
+    { 0xa9782ab165e68b1cu, 0x12c4cf8ea6b6ec76u }, { 0x0f26aab56fd744fau, 0x1e07b27dd78b13f1u },
+    { 0x3f52222abfdf6a62u, 0x18062864ac6f4327u }, { 0x65db4e88997f884eu, 0x1338205089f29c1fu },
+    { 0x6fc54a7428cc0d4au, 0x1ec033b40fea9365u }, { 0x596aa1f68709a43bu, 0x1899c2f673220f84u },
+    { 0xadeee7f86c07b696u, 0x13ae3591f5b4d936u }, { 0x497e3ff3e00c5756u, 0x1f7d228322baf524u },
+    { 0xd464fff64cd6ac45u, 0x1930e868e89590e9u }, { 0x4383fff83d7889d1u, 0x14272053ed4473eeu },
+    { 0xcf9cccc69793a174u, 0x101f4d0ff1038ff1u }, { 0x7f6147a425b90252u, 0x19cbae7fe805b31cu },
+    { 0xcc4dd2e9b7c7350fu, 0x14a2f1ffecd15c16u }, { 0x3d0b0f215fd290d9u, 0x10825b3323dab012u },
+    { 0x61ab4b689950e7c1u, 0x1a6a2b85062ab350u }, { 0x4e22a2ba1440b967u, 0x1521bc6a6b555c40u },
+    { 0x0b4ee894dd009453u, 0x10e7c9eebc4449cdu }, { 0x1217da87c800ed51u, 0x1b0c764ac6d3a948u },
+    { 0xdb46486ca000bddau, 0x15a391d56bdc876cu }, { 0x490506bd4ccd64afu, 0x114fa7ddefe39f8au },
+    { 0xa8080ac87ae23ab1u, 0x1bb2a62fe638ff43u }, { 0x5339a239fbe82ef4u, 0x162884f31e93ff69u },
+    { 0x75c7b4fb2fecf25du, 0x11ba03f5b20fff87u }, { 0x22d92191e647ea2eu, 0x1c5cd322b67fff3fu },
+    { 0xb57a8141850654f2u, 0x16b0a8e891ffff65u }, { 0xc4620101373843f5u, 0x1226ed86db3332b7u },
+    { 0x3a366801f1f39feeu, 0x1d0b15a491eb8459u }, { 0xfb5eb99b27f6198bu, 0x173c115074bc69e0u },
+    { 0x2f7efae2865e7ad6u, 0x129674405d6387e7u }, { 0xe597f7d0d6fd9156u, 0x1dbd86cd6238d971u },
+    { 0x8479930d78cadaabu, 0x17cad23de82d7ac1u }, { 0xd06142712d6f1556u, 0x1308a831868ac89au },
+    { 0x4d686a4eaf182222u, 0x1e74404f3daada91u }, { 0xa453883ef279b4e8u, 0x185d003f6488aedau },
+    { 0xe9dc6cff28615d87u, 0x137d99cc506d58aeu }, { 0xa960ae650d6895a4u, 0x1f2f5c7a1a488de4u },
+    { 0xbab3beb73ded4483u, 0x18f2b061aea07183u }
+};
+static const uint64_t _pow5[326][2] = {       // 5^i, to its top 125 bits
+    { 0x0000000000000000u, 0x1000000000000000u }, { 0x0000000000000000u, 0x1400000000000000u },
+    { 0x0000000000000000u, 0x1900000000000000u }, { 0x0000000000000000u, 0x1f40000000000000u },
+    { 0x0000000000000000u, 0x1388000000000000u }, { 0x0000000000000000u, 0x186a000000000000u },
+    { 0x0000000000000000u, 0x1e84800000000000u }, { 0x0000000000000000u, 0x1312d00000000000u },
+    { 0x0000000000000000u, 0x17d7840000000000u }, { 0x0000000000000000u, 0x1dcd650000000000u },
+    { 0x0000000000000000u, 0x12a05f2000000000u }, { 0x0000000000000000u, 0x174876e800000000u },
+    { 0x0000000000000000u, 0x1d1a94a200000000u }, { 0x0000000000000000u, 0x12309ce540000000u },
+    { 0x0000000000000000u, 0x16bcc41e90000000u }, { 0x0000000000000000u, 0x1c6bf52634000000u },
+    { 0x0000000000000000u, 0x11c37937e0800000u }, { 0x0000000000000000u, 0x16345785d8a00000u },
+    { 0x0000000000000000u, 0x1bc16d674ec80000u }, { 0x0000000000000000u, 0x1158e460913d0000u },
+    { 0x0000000000000000u, 0x15af1d78b58c4000u }, { 0x0000000000000000u, 0x1b1ae4d6e2ef5000u },
+    { 0x0000000000000000u, 0x10f0cf064dd59200u }, { 0x0000000000000000u, 0x152d02c7e14af680u },
+    { 0x0000000000000000u, 0x1a784379d99db420u }, { 0x0000000000000000u, 0x108b2a2c28029094u },
+    { 0x0000000000000000u, 0x14adf4b7320334b9u }, { 0x4000000000000000u, 0x19d971e4fe8401e7u },
+    { 0x8800000000000000u, 0x1027e72f1f128130u }, { 0xaa00000000000000u, 0x1431e0fae6d7217cu },
+    { 0xd480000000000000u, 0x193e5939a08ce9dbu }, { 0xc9a0000000000000u, 0x1f8def8808b02452u },
+    { 0xbe04000000000000u, 0x13b8b5b5056e16b3u }, { 0xad85000000000000u, 0x18a6e32246c99c60u },
+    { 0xd8e6400000000000u, 0x1ed09bead87c0378u }, { 0x878fe80000000000u, 0x13426172c74d822bu },
+    { 0x6973e20000000000u, 0x1812f9cf7920e2b6u }, { 0x03d0da8000000000u, 0x1e17b84357691b64u },
+    { 0x8262889000000000u, 0x12ced32a16a1b11eu }, { 0x22fb2ab400000000u, 0x178287f49c4a1d66u },
+    { 0xabb9f56100000000u, 0x1d6329f1c35ca4bfu }, { 0xcb54395ca0000000u, 0x125dfa371a19e6f7u },
+    { 0xbe2947b3c8000000u, 0x16f578c4e0a060b5u }, { 0x2db399a0ba000000u, 0x1cb2d6f618c878e3u },
+    { 0xfc90400474400000u, 0x11efc659cf7d4b8du }, { 0x7bb4500591500000u, 0x166bb7f0435c9e71u },
+    { 0xdaa16406f5a40000u, 0x1c06a5ec5433c60du }, { 0xa8a4de8459868000u, 0x118427b3b4a05bc8u },
+    { 0xd2ce16256fe82000u, 0x15e531a0a1c872bau }, { 0x87819baecbe22800u, 0x1b5e7e08ca3a8f69u },
+    { 0xf4b1014d3f6d5900u, 0x111b0ec57e6499a1u }, { 0x71dd41a08f48af40u, 0x1561d276ddfdc00au },
+    { 0x0e549208b31adb10u, 0x1aba4714957d300du }, { 0x28f4db456ff0c8eau, 0x10b46c6cdd6e3e08u },
+    { 0x33321216cbecfb24u, 0x14e1878814c9cd8au }, { 0xbffe969c7ee839edu, 0x1a19e96a19fc40ecu },
+    { 0xf7ff1e21cf512434u, 0x105031e2503da893u }, { 0xf5fee5aa43256d41u, 0x14643e5ae44d12b8u },
+    { 0x337e9f14d3eec892u, 0x197d4df19d605767u }, { 0x005e46da08ea7ab6u, 0x1fdca16e04b86d41u },
+    { 0xa03aec4845928cb2u, 0x13e9e4e4c2f34448u }, { 0xc849a75a56f72fdeu, 0x18e45e1df3b0155au },
+    { 0x7a5c1130ecb4fbd6u, 0x1f1d75a5709c1ab1u }, { 0xec798abe93f11d65u, 0x13726987666190aeu },
+    { 0xa797ed6e38ed64bfu, 0x184f03e93ff9f4dau }, { 0x517de8c9c728bdefu, 0x1e62c4e38ff87211u },
+    { 0xd2eeb17e1c7976b5u, 0x12fdbb0e39fb474au }, { 0x87aa5ddda397d462u, 0x17bd29d1c87a191du },
+    { 0xe994f5550c7dc97bu, 0x1dac74463a989f64u }, { 0x11fd195527ce9dedu, 0x128bc8abe49f639fu },
+    { 0xd67c5faa71c24568u, 0x172ebad6ddc73c86u }, { 0x8c1b77950e32d6c2u, 0x1cfa698c95390ba8u },
+    { 0x57912abd28dfc639u, 0x121c81f7dd43a749u }, { 0xad75756c7317b7c8u, 0x16a3a275d494911bu },
+    { 0x98d2d2c78fdda5bau, 0x1c4c8b1349b9b562u }, { 0x9f83c3bcb9ea8794u, 0x11afd6ec0e14115du },
+    { 0x0764b4abe8652979u, 0x161bcca7119915b5u }, { 0x493de1d6e27e73d7u, 0x1ba2bfd0d5ff5b22u },
+    { 0x6dc6ad264d8f0866u, 0x1145b7e285bf98f5u }, { 0xc938586fe0f2ca80u, 0x159725db272f7f32u },
+    { 0x7b866e8bd92f7d20u, 0x1afcef51f0fb5effu }, { 0xad34051767bdae34u, 0x10de1593369d1b5fu },
+    { 0x9881065d41ad19c1u, 0x15159af804446237u }, { 0x7ea147f492186032u, 0x1a5b01b605557ac5u },
+    { 0x6f24ccf8db4f3c1fu, 0x1078e111c3556cbbu }, { 0x4aee003712230b27u, 0x14971956342ac7eau },
+    { 0xdda98044d6abcdf0u, 0x19bcdfabc13579e4u }, { 0x0a89f02b062b60b6u, 0x10160bcb58c16c2fu },
+    { 0xcd2c6c35c7b638e4u, 0x141b8ebe2ef1c73au }, { 0x8077874339a3c71du, 0x1922726dbaae3909u },
+    { 0xe0956914080cb8e4u, 0x1f6b0f092959c74bu }, { 0x6c5d61ac8507f38eu, 0x13a2e965b9d81c8fu },
+    { 0x4774ba17a649f072u, 0x188ba3bf284e23b3u }, { 0x1951e89d8fdc6c8fu, 0x1eae8caef261aca0u },
+    { 0x0fd3316279e9c3d9u, 0x132d17ed577d0be4u }, { 0x13c7fdbb186434cfu, 0x17f85de8ad5c4eddu },
+    { 0x58b9fd29de7d4203u, 0x1df67562d8b36294u }, { 0xb7743e3a2b0e4942u, 0x12ba095dc7701d9cu },
+    { 0xe5514dc8b5d1db92u, 0x17688bb5394c2503u }, { 0xdea5a13ae3465277u, 0x1d42aea2879f2e44u },
+    { 0x0b2784c4ce0bf38au, 0x1249ad2594c37cebu }, { 0xcdf165f6018ef06du, 0x16dc186ef9f45c25u },
+    { 0x416dbf7381f2ac88u, 0x1c931e8ab871732fu }, { 0x88e497a83137abd5u, 0x11dbf316b346e7fdu },
+    { 0xeb1dbd923d8596cau, 0x1652efdc6018a1fcu }, { 0x25e52cf6cce6fc7du, 0x1be7abd3781eca7cu },
+    { 0x97af3c1a40105dceu, 0x1170cb642b133e8du }, { 0xfd9b0b20d0147542u, 0x15ccfe3d35d80e30u },
+    { 0x3d01cde904199292u, 0x1b403dcc834e11bdu }, { 0x462120b1a28ffb9bu, 0x1108269fd210cb16u },
+    { 0xd7a968de0b33fa82u, 0x154a3047c694fddbu }, { 0xcd93c3158e00f923u, 0x1a9cbc59b83a3d52u },
+    { 0xc07c59ed78c09bb6u, 0x10a1f5b813246653u }, { 0xb09b7068d6f0c2a3u, 0x14ca732617ed7fe8u },
+    { 0xdcc24c830cacf34cu, 0x19fd0fef9de8dfe2u }, { 0xc9f96fd1e7ec180fu, 0x103e29f5c2b18bedu },
+    { 0x3c77cbc661e71e13u, 0x144db473335deee9u }, { 0x8b95beb7fa60e598u, 0x1961219000356aa3u },
+    { 0x6e7b2e65f8f91efeu, 0x1fb969f40042c54cu }, { 0xc50cfcffbb9bb35fu, 0x13d3e2388029bb4fu },
+    { 0xb6503c3faa82a037u, 0x18c8dac6a0342a23u }, { 0xa3e44b4f95234844u, 0x1efb1178484134acu },
+    { 0xe66eaf11bd360d2bu, 0x135ceaeb2d28c0ebu }, { 0xe00a5ad62c839075u, 0x183425a5f872f126u },
+    { 0x980cf18bb7a47493u, 0x1e412f0f768fad70u }, { 0x5f0816f752c6c8dcu, 0x12e8bd69aa19cc66u },
+    { 0xf6ca1cb527787b13u, 0x17a2ecc414a03f7fu }, { 0xf47ca3e2715699d7u, 0x1d8ba7f519c84f5fu },
+    { 0xf8cde66d86d62026u, 0x127748f9301d319bu }, { 0xf7016008e88ba830u, 0x17151b377c247e02u },
+    { 0xb4c1b80b22ae923cu, 0x1cda62055b2d9d83u }, { 0x50f91306f5ad1b65u, 0x12087d4358fc8272u },
+    { 0xe53757c8b318623fu, 0x168a9c942f3ba30eu }, { 0x9e852dbadfde7acfu, 0x1c2d43b93b0a8bd2u },
+    { 0xa3133c94cbeb0cc1u, 0x119c4a53c4e69763u }, { 0x8bd80bb9fee5cff1u, 0x16035ce8b6203d3cu },
+    { 0xaece0ea87e9f43eeu, 0x1b843422e3a84c8bu }, { 0x4d40c9294f238a75u, 0x1132a095ce492fd7u },
+    { 0x2090fb73a2ec6d12u, 0x157f48bb41db7bcdu }, { 0x68b53a508ba78856u, 0x1adf1aea12525ac0u },
+    { 0x417144725748b536u, 0x10cb70d24b7378b8u }, { 0x51cd958eed1ae283u, 0x14fe4d06de5056e6u },
+    { 0xe640faf2a8619b24u, 0x1a3de04895e46c9fu }, { 0xefe89cd7a93d00f7u, 0x1066ac2d5daec3e3u },
+    { 0xebe2c40d938c4134u, 0x14805738b51a74dcu }, { 0x26db7510f86f5181u, 0x19a06d06e2611214u },
+    { 0x9849292a9b4592f1u, 0x100444244d7cab4cu }, { 0xbe5b73754216f7adu, 0x1405552d60dbd61fu },
+    { 0xadf25052929cb598u, 0x1906aa78b912cba7u }, { 0x996ee4673743e2ffu, 0x1f485516e7577e91u },
+    { 0xffe54ec0828a6ddfu, 0x138d352e5096af1au }, { 0xbfdea270a32d0957u, 0x18708279e4bc5ae1u },
+    { 0x2fd64b0ccbf84badu, 0x1e8ca3185deb719au }, { 0x5de5eee7ff7b2f4cu, 0x1317e5ef3ab32700u },
+    { 0x755f6aa1ff59fb1fu, 0x17dddf6b095ff0c0u }, { 0x92b7454a7f3079e7u, 0x1dd55745cbb7ecf0u },
+    { 0x5bb28b4e8f7e4c30u, 0x12a5568b9f52f416u }, { 0xf29f2e22335ddf3cu, 0x174eac2e8727b11bu },
+    { 0xef46f9aac035570bu, 0x1d22573a28f19d62u }, { 0xd58c5c0ab8215667u, 0x123576845997025du },
+    { 0x4aef730d6629ac01u, 0x16c2d4256ffcc2f5u }, { 0x9dab4fd0bfb41701u, 0x1c73892ecbfbf3b2u },
+    { 0xa28b11e277d08e60u, 0x11c835bd3f7d784fu }, { 0x8b2dd65b15c4b1f9u, 0x163a432c8f5cd663u },
+    { 0x6df94bf1db35de77u, 0x1bc8d3f7b3340bfcu }, { 0xc4bbcf772901ab0au, 0x115d847ad000877du },
+    { 0x35eac354f34215cdu, 0x15b4e5998400a95du }, { 0x8365742a30129b40u, 0x1b221effe500d3b4u },
+    { 0xd21f689a5e0ba108u, 0x10f5535fef208450u }, { 0x06a742c0f58e894au, 0x1532a837eae8a565u },
+    { 0x4851137132f22b9du, 0x1a7f5245e5a2cebeu }, { 0xed32ac26bfd75b42u, 0x108f936baf85c136u },
+    { 0xa87f57306fcd3212u, 0x14b378469b673184u }, { 0xd29f2cfc8bc07e97u, 0x19e056584240fde5u },
+    { 0xa3a37c1dd7584f1eu, 0x102c35f729689eafu }, { 0x8c8c5b254d2e62e6u, 0x14374374f3c2c65bu },
+    { 0x6faf71eea079fb9fu, 0x1945145230b377f2u }, { 0x0b9b4e6a48987a87u, 0x1f965966bce055efu },
+    { 0x674111026d5f4c94u, 0x13bdf7e0360c35b5u }, { 0xc111554308b71fbau, 0x18ad75d8438f4322u },
+    { 0x7155aa93cae4e7a8u, 0x1ed8d34e547313ebu }, { 0x26d58a9c5ecf10c9u, 0x13478410f4c7ec73u },
+    { 0xf08aed437682d4fbu, 0x1819651531f9e78fu }, { 0xecada89454238a3au, 0x1e1fbe5a7e786173u },
+    { 0x73ec895cb4963664u, 0x12d3d6f88f0b3ce8u }, { 0x90e7abb3e1bbc3fdu, 0x1788ccb6b2ce0c22u },
+    { 0x352196a0da2ab4fdu, 0x1d6affe45f818f2bu }, { 0x0134fe24885ab11eu, 0x1262dfeebbb0f97bu },
+    { 0xc1823dadaa715d65u, 0x16fb97ea6a9d37d9u }, { 0x31e2cd19150db4bfu, 0x1cba7de5054485d0u },
+    { 0x1f2dc02fad2890f7u, 0x11f48eaf234ad3a2u }, { 0xa6f9303b9872b535u, 0x1671b25aec1d888au },
+    { 0x50b77c4a7e8f6282u, 0x1c0e1ef1a724eaadu }, { 0x5272adae8f199d91u, 0x1188d357087712acu },
+    { 0x670f591a32e004f6u, 0x15eb082cca94d757u }, { 0x40d32f60bf980633u, 0x1b65ca37fd3a0d2du },
+    { 0x4883fd9c77bf03e0u, 0x111f9e62fe44483cu }, { 0x5aa4fd0395aec4d8u, 0x156785fbbdd55a4bu },
+    { 0x314e3c447b1a760eu, 0x1ac1677aad4ab0deu }, { 0xded0e5aaccf089c9u, 0x10b8e0acac4eae8au },
+    { 0x96851f15802cac3bu, 0x14e718d7d7625a2du }, { 0xfc2666dae037d74au, 0x1a20df0dcd3af0b8u },
+    { 0x9d980048cc22e68eu, 0x10548b68a044d673u }, { 0x84fe005aff2ba032u, 0x1469ae42c8560c10u },
+    { 0xa63d8071bef6883eu, 0x198419d37a6b8f14u }, { 0xcfcce08e2eb42a4eu, 0x1fe52048590672d9u },
+    { 0x21e00c58dd309a70u, 0x13ef342d37a407c8u }, { 0x2a580f6f147cc10du, 0x18eb0138858d09bau },
+    { 0xb4ee134ad99bf150u, 0x1f25c186a6f04c28u }, { 0x7114cc0ec80176d2u, 0x137798f428562f99u },
+    { 0xcd59ff127a01d486u, 0x18557f31326bbb7fu }, { 0xc0b07ed7188249a8u, 0x1e6adefd7f06aa5fu },
+    { 0xd86e4f466f516e09u, 0x1302cb5e6f642a7bu }, { 0xce89e3180b25c98bu, 0x17c37e360b3d351au },
+    { 0x822c5bde0def3beeu, 0x1db45dc38e0c8261u }, { 0xf15bb96ac8b58575u, 0x1290ba9a38c7d17cu },
+    { 0x2db2a7c57ae2e6d2u, 0x1734e940c6f9c5dcu }, { 0x391f51b6d99ba086u, 0x1d022390f8b83753u },
+    { 0x03b3931248014454u, 0x1221563a9b732294u }, { 0x04a077d6da019569u, 0x16a9abc9424feb39u },
+    { 0x45c895cc9081fac3u, 0x1c5416bb92e3e607u }, { 0x8b9d5d9fda513cbau, 0x11b48e353bce6fc4u },
+    { 0xae84b507d0e58be8u, 0x1621b1c28ac20bb5u }, { 0x1a25e249c51eeee3u, 0x1baa1e332d728ea3u },
+    { 0xf057ad6e1b33554du, 0x114a52dffc679925u }, { 0x6c6d98c9a2002aa1u, 0x159ce797fb817f6fu },
+    { 0x4788fefc0a803549u, 0x1b04217dfa61df4bu }, { 0x0cb59f5d8690214eu, 0x10e294eebc7d2b8fu },
+    { 0xcfe30734e83429a1u, 0x151b3a2a6b9c7672u }, { 0x83dbc9022241340au, 0x1a6208b50683940fu },
+    { 0xb2695da15568c086u, 0x107d457124123c89u }, { 0x1f03b509aac2f0a7u, 0x149c96cd6d16cbacu },
+    { 0x26c4a24c1573acd1u, 0x19c3bc80c85c7e97u }, { 0x783ae56f8d684c03u, 0x101a55d07d39cf1eu },
+    { 0x16499ecb70c25f03u, 0x1420eb449c8842e6u }, { 0x9bdc067e4cf2f6c4u, 0x19292615c3aa539fu },
+    { 0x82d3081de02fb476u, 0x1f736f9b3494e887u }, { 0xb1c3e512ac1dd0c9u, 0x13a825c100dd1154u },
+    { 0xde34de57572544fcu, 0x18922f31411455a9u }, { 0x55c215ed2cee963bu, 0x1eb6bafd91596b14u },
+    { 0xb5994db43c151de5u, 0x133234de7ad7e2ecu }, { 0xe2ffa1214b1a655eu, 0x17fec216198ddba7u },
+    { 0xdbbf89699de0feb6u, 0x1dfe729b9ff15291u }, { 0x2957b5e202ac9f31u, 0x12bf07a143f6d39bu },
+    { 0xf3ada35a8357c6feu, 0x176ec98994f48881u }, { 0x70990c31242db8bdu, 0x1d4a7bebfa31aaa2u },
+    { 0x865fa79eb69c9376u, 0x124e8d737c5f0aa5u }, { 0xe7f791866443b854u, 0x16e230d05b76cd4eu },
+    { 0xa1f575e7fd54a669u, 0x1c9abd04725480a2u }, { 0xa53969b0fe54e801u, 0x11e0b622c774d065u },
+    { 0x0e87c41d3dea2202u, 0x1658e3ab7952047fu }, { 0xd229b5248d64aa82u, 0x1bef1c9657a6859eu },
+    { 0x435a1136d85eea91u, 0x117571ddf6c81383u }, { 0x143095848e76a536u, 0x15d2ce55747a1864u },
+    { 0x193cbae5b2144e83u, 0x1b4781ead1989e7du }, { 0x2fc5f4cf8f4cb112u, 0x110cb132c2ff630eu },
+    { 0xbbb77203731fdd56u, 0x154fdd7f73bf3bd1u }, { 0x2aa54e844fe7d4acu, 0x1aa3d4df50af0ac6u },
+    { 0xdaa75112b1f0e4ebu, 0x10a6650b926d66bbu }, { 0xd15125575e6d1e26u, 0x14cffe4e7708c06au },
+    { 0x85a56ead360865b0u, 0x1a03fde214caf085u }, { 0x7387652c41c53f8eu, 0x10427ead4cfed653u },
+    { 0x50693e7752368f71u, 0x14531e58a03e8be8u }, { 0x64838e1526c4334eu, 0x1967e5eec84e2ee2u },
+    { 0xfda4719a70754022u, 0x1fc1df6a7a61ba9au }, { 0xde86c70086494815u, 0x13d92ba28c7d14a0u },
+    { 0x162878c0a7db9a1au, 0x18cf768b2f9c59c9u }, { 0x5bb296f0d1d280a1u, 0x1f03542dfb83703bu },
+    { 0x194f9e5683239064u, 0x1362149cbd322625u }, { 0x5fa385ec23ec747eu, 0x183a99c3ec7eafaeu },
+    { 0xf78c67672ce7919du, 0x1e494034e79e5b99u }, { 0x3ab7c0a07c10bb02u, 0x12edc82110c2f940u },
+    { 0x4965b0c89b14e9c3u, 0x17a93a2954f3b790u }, { 0x5bbf1cfac1da2433u, 0x1d9388b3aa30a574u },
+    { 0xb957721cb92856a0u, 0x127c35704a5e6768u }, { 0xe7ad4ea3e7726c48u, 0x171b42cc5cf60142u },
+    { 0xa198a24ce14f075au, 0x1ce2137f74338193u }, { 0x44ff65700cd16498u, 0x120d4c2fa8a030fcu },
+    { 0x563f3ecc1005bdbeu, 0x16909f3b92c83d3bu }, { 0x2bcf0e7f14072d2eu, 0x1c34c70a777a4c8au },
+    { 0x5b61690f6c847c3du, 0x11a0fc668aac6fd6u }, { 0xf239c35347a59b4cu, 0x16093b802d578bcbu },
+    { 0xeec83428198f021fu, 0x1b8b8a6038ad6ebeu }, { 0x553d20990ff96153u, 0x1137367c236c6537u },
+    { 0x2a8c68bf53f7b9a8u, 0x1585041b2c477e85u }, { 0x752f82ef28f5a812u, 0x1ae64521f7595e26u },
+    { 0x093db1d57999890bu, 0x10cfeb353a97dad8u }, { 0x0b8d1e4ad7ffeb4eu, 0x1503e602893dd18eu },
+    { 0x8e7065dd8dffe622u, 0x1a44df832b8d45f1u }, { 0xf9063faa78bfefd5u, 0x106b0bb1fb384bb6u },
+    { 0xb747cf9516efebcau, 0x1485ce9e7a065ea4u }, { 0xe519c37a5cabe6bdu, 0x19a742461887f64du },
+    { 0xaf301a2c79eb7036u, 0x1008896bcf54f9f0u }, { 0xdafc20b798664c43u, 0x140aabc6c32a386cu },
+    { 0x11bb28e57e7fdf54u, 0x190d56b873f4c688u }, { 0x1629f31ede1fd72au, 0x1f50ac6690f1f82au },
+    { 0x4dda37f34ad3e67au, 0x13926bc01a973b1au }, { 0xe150c5f01d88e019u, 0x187706b0213d09e0u },
+    { 0x19a4f76c24eb181fu, 0x1e94c85c298c4c59u }, { 0xb0071aa39712ef13u, 0x131cfd3999f7afb7u },
+    { 0x9c08e14c7cd7aad8u, 0x17e43c8800759ba5u }, { 0x030b199f9c0d958eu, 0x1ddd4baa0093028fu },
+    { 0x61e6f003c1887d79u, 0x12aa4f4a405be199u }, { 0xba60ac04b1ea9cd7u, 0x1754e31cd072d9ffu },
+    { 0xa8f8d705de65440du, 0x1d2a1be4048f907fu }, { 0xc99b8663aaff4a88u, 0x123a516e82d9ba4fu },
+    { 0xbc0267fc95bf1d2au, 0x16c8e5ca239028e3u }, { 0xab0301fbbb2ee474u, 0x1c7b1f3cac74331cu },
+    { 0xeae1e13d54fd4ec9u, 0x11ccf385ebc89ff1u }, { 0x659a598caa3ca27bu, 0x1640306766bac7eeu },
+    { 0xff00efefd4cbcb1au, 0x1bd03c81406979e9u }, { 0x3f6095f5e4ff5ef0u, 0x116225d0c841ec32u },
+    { 0xcf38bb735e3f36acu, 0x15baaf44fa52673eu }, { 0x8306ea5035cf0457u, 0x1b295b1638e7010eu },
+    { 0x11e4527221a162b6u, 0x10f9d8ede39060a9u }, { 0x565d670eaa09bb64u, 0x15384f295c7478d3u },
+    { 0x2bf4c0d2548c2a3du, 0x1a8662f3b3919708u }, { 0x1b78f88374d79a66u, 0x1093fdd8503afe65u },
+    { 0x625736a4520d8100u, 0x14b8fd4e6449bdfeu }, { 0xfaed044d6690e140u, 0x19e73ca1fd5c2d7du },
+    { 0xbcd422b0601a8cc8u, 0x103085e53e599c6eu }, { 0x6c092b5c78212ffau, 0x143ca75e8df0038au },
+    { 0x070b763396297bf8u, 0x194bd136316c046du }, { 0x48ce53c07bb3daf6u, 0x1f9ec583bdc70588u },
+    { 0x2d80f4584d5068dau, 0x13c33b72569c6375u }, { 0x78e1316e60a48310u, 0x18b40a4eec437c52u }
+};
+
+ // ceil(log2(5^e)), floor(log10(2^e)), floor(log10(5^e)), for the exponents
+ // of a double
+PRIVATE
+int32_t _pow5_bits(int32_t e) { return (int32_t)(((uint32_t)e * 1217359) >> 19) + 1; }
+PRIVATE
+int32_t _log10_pow2(int32_t e) { return (int32_t)(((uint32_t)e * 78913) >> 18); }
+PRIVATE
+int32_t _log10_pow5(int32_t e) { return (int32_t)(((uint32_t)e * 732923) >> 20); }
+
+PRIVATE
+bool _multiple_of_pow5(uint64_t u, int32_t p)
+{
+    int32_t n = 0;
+    for (; u % 5 == 0; u /= 5) {
+      n++; }
+    return n >= p;
 }
 
 PRIVATE
-errno_t _list_get_value(List* list, size_t idx, Value** val)
+bool _multiple_of_pow2(uint64_t u, int32_t p)
 {
-    if (!_list_lock(list))
-    {   free(*val);
-        return errno = EAGAIN; }
+    return (u & ((UINT64_C(1) << p) - 1)) == 0;
+}
 
-    Value* c = list->first;
-    for (typeof(idx) i = 0; i < idx; i++) { // C23
-      c = c->next; }
-    memcpy((void*)*val, (void*)c, sizeof(Value));
+ // (m * mul) >> j, for 64 < j < 128
+PRIVATE
+uint64_t _mul_shift(uint64_t m, const uint64_t* mul, int32_t j)
+{
+#ifdef __SIZEOF_INT128__
+    unsigned __int128 b0 = (unsigned __int128)m * mul[0];
+    unsigned __int128 b2 = (unsigned __int128)m * mul[1];
+    return (uint64_t)(((b0 >> 64) + b2) >> (j - 64));
+#else
+    // 64x64 -> 128 by 32-bit halves
+    uint64_t h[2], l[2];
+    for (int k = 0; k < 2; k++)
+    { uint64_t a0 = (uint32_t)m, a1 = m >> 32;
+      uint64_t b0 = (uint32_t)mul[k], b1 = mul[k] >> 32;
+      uint64_t p00 = a0 * b0, p01 = a0 * b1, p10 = a1 * b0, p11 = a1 * b1;
+      uint64_t mid = (p00 >> 32) + (uint32_t)p01 + (uint32_t)p10;
+      l[k] = (mid << 32) | (uint32_t)p00;
+      h[k] = p11 + (p01 >> 32) + (p10 >> 32) + (mid >> 32); }
+    uint64_t lo = h[0] + l[1];
+    uint64_t hi = h[1] + (lo < h[0]);
+    int32_t d = j - 64;
+    return (hi << (64 - d)) | (lo >> d);
+#endif
+}
 
-    mtx_unlock(&list->locked);
+ // finite, non-zero "f": its shortest "m * 10^e" (the closest if several)
+PRIVATE
+uint64_t _float_shortest(double f, int32_t* e)
+{
+    uint64_t bits;
+    memcpy(&bits, &f, sizeof(bits));
+    uint64_t mantissa = bits & ((UINT64_C(1) << 52) - 1);
+    int32_t exponent = (int32_t)((bits >> 52) & 0x7FF);
 
-    return EXIT_SUCCESS;
-}
+    // f = m2 * 2^e2, between halfway points (4*m2 - 1 - mm) and (4*m2 + 2)
+    int32_t e2 = (exponent ? exponent : 1) - 1023 - 52 - 2;
+    uint64_t m2 = exponent ? (UINT64_C(1) << 52) | mantissa : mantissa;
+    bool even = (m2 & 1) == 0;
+    uint64_t mv = 4 * m2;
+    uint32_t mm = (mantissa != 0 || exponent <= 1);
 
+    // the three in decimal, dropping q digits (tracking if all were zeros)
+    uint64_t vr, vp, vm;
+    int32_t e10;
+    bool vm_zeros = false, vr_zeros = false;
+    if (e2 >= 0) {
+      int32_t q = _log10_pow2(e2) - (e2 > 3);
+      int32_t j = -e2 + q + POW5_INV_BITS + _pow5_bits(q) - 1;
+      e10 = q;
+      vr = _mul_shift(4 * m2, _pow5_inv[q], j);
+      vp = _mul_shift(4 * m2 + 2, _pow5_inv[q], j);
+      vm = _mul_shift(4 * m2 - 1 - mm, _pow5_inv[q], j);
+      if (q <= 21) {
+        if (mv % 5 == 0) {
+          vr_zeros = _multiple_of_pow5(mv, q); }
+        else if (even) {
+          vm_zeros = _multiple_of_pow5(mv - 1 - mm, q); }
+        else {
+          vp -= _multiple_of_pow5(mv + 2, q); }
+      }
+    } else {
+      int32_t q = _log10_pow5(-e2) - (-e2 > 1);
+      int32_t i = -e2 - q;
+      int32_t j = q - (_pow5_bits(i) - POW5_BITS);
+      e10 = q + e2;
+      vr = _mul_shift(4 * m2, _pow5[i], j);
+      vp = _mul_shift(4 * m2 + 2, _pow5[i], j);
+      vm = _mul_shift(4 * m2 - 1 - mm, _pow5[i], j);
+      if (q <= 1) {
+        vr_zeros = true;
+        if (even) {
+          vm_zeros = (mm == 1); }
+        else {
+          vp--; }
+      } else if (q < 63) {
+        vr_zeros = _multiple_of_pow2(mv, q);
+      }
+    }
 
-// PUBLIC FUNCTION IMPLEMENTATIONS
+    // then as many more as still leave us between the halfway points
+    int32_t removed = 0;
+    uint64_t out;
+    if (vm_zeros || vr_zeros) {
+      uint32_t last = 0;
+      for (; vp / 10 > vm / 10; removed++) {
+        vm_zeros &= (vm % 10 == 0);
+        vr_zeros &= (last == 0);
+        last = (uint32_t)(vr % 10);
+        vr /= 10; vp /= 10; vm /= 10; }
+      if (vm_zeros) {
+        for (; vm % 10 == 0; removed++) {
+          vr_zeros &= (last == 0);
+          last = (uint32_t)(vr % 10);
+          vr /= 10; vp /= 10; vm /= 10; }
+      }
+      if (vr_zeros && last == 5 && vr % 2 == 0) {
+        last = 4; }                     // exactly halfway: to even
+      out = vr + ((vr == vm && (!even || !vm_zeros)) || last >= 5);
+    } else {
+      // (common case: no ties to care about)
+      bool up = false;
+      if (vp / 100 > vm / 100)
+      { up = (vr % 100 >= 50);
+        vr /= 100; vp /= 100; vm /= 100;
+        removed += 2; }
+      for (; vp / 10 > vm / 10; removed++) {
+        up = (vr % 10 >= 5);
+        vr /= 10; vp /= 10; vm /= 10; }
+      out = vr + (vr == vm || up);
+    }
 
-PUBLIC
-List* list_create(unsigned int timeout)
+    *e = e10 + removed;
+    return out;
+}
+
+PRIVATE
+size_t _format_float(char* buf, double f)
 {
-    auto l = (List*) calloc(1, sizeof(List)); // C23
-    l->timeout = timeout;
-    mtx_init(&l->locked, mtx_recursive | mtx_timed);
+    // integral values below 2^53 are exact, take the integer path
+    if (fabs(f) < 9007199254740992.0 && f == trunc(f) && !(f == 0.0 && signbit(f))) {
+      return _format_int(buf, (int64_t)f); }
+    if (!isfinite(f) || f == 0.0) {
+      return (size_t)_snprintf_c(buf, VALUE_TEXT_MAX, "%g", f); }   // "-0", "inf"...
 
-    return l;
+    // otherwise the shortest digits that read back as the same double, laid
+    // out as "%.<digits>g" would
+    int32_t e;
+    char digits[20];
+    size_t n = _format_uint(digits, _float_shortest(f, &e));
+    int32_t x = e + (int32_t)n - 1;      // exponent of the first digit
+
+    char* p = buf;
+    if (signbit(f)) {
+      *p++ = '-'; }
+    if (x >= -4 && x < (int32_t)n) {
+      if (x < 0) {
+        memcpy(p, "0.0000", 1 - x);
+        p += 1 - x;
+        memcpy(p, digits, n);
+        p += n;
+      } else {
+        memcpy(p, digits, x + 1);
+        p += x + 1;
+        if (n > (size_t)x + 1)
+        { *p++ = '.';
+          memcpy(p, digits + x + 1, n - x - 1);
+          p += n - x - 1; }
+      }
+    } else {
+      *p++ = digits[0];
+      if (n > 1)
+      { *p++ = '.';
+        memcpy(p, digits + 1, n - 1);
+        p += n - 1; }
+      *p++ = 'e';
+      *p++ = (x < 0) ? '-' : '+';
+      uint32_t ax = (uint32_t)((x < 0) ? -x : x);
+      if (ax < 10) {
+        *p++ = '0'; }
+      p += _format_uint(p, ax);
+    }
+    *p = '\0';
+
+    return (size_t)(p - buf);
 }
 
-PUBLIC
+ // renders non-string values in "buf" (at least VALUE_TEXT_MAX long)
+PRIVATE
+size_t _value_render(Value* v, char* buf)
+{
+    switch (v->t) {
+      case T_INTEGER: return _format_int(buf, v->i);
+      case T_BOOLEAN: return strlen(strcpy(buf, v->b ?"true":"false"));
+      case T_FLOAT  : return _format_float(buf, v->f);
+      case T_INT64  : return _format_int(buf, v->l);
+      default       : buf[0] = '\0'; return 0;
+    }
+}
+
+PRIVATE
+errno_t _value_get_string_buf(List* list, Value* v, char* buf, size_t len)
+{
+    errno_t e = _value_get_Type(v, nullptr);
+    if (e == EUNDEF) {
+        return EUNDEF; }
+
+    char tmp[VALUE_TEXT_MAX];
+    const char* s = tmp;
+    size_t n;
+
+    if (v->t == T_STRING) {
+      s = v->s ? v->s : "";           // nullptr strings are legal
+      n = strlen(s);
+      e = EXIT_SUCCESS;
+    } else if (v->t == T_BLOB) {
+      s = (const char*)_value_bytes(v);
+      n = v->n;
+    } else if ((list->flags & LIST_STRCACHE) && *_value_cache(v)) {
+      s = *_value_cache(v);
+      n = strlen(s);
+    } else {
+      n = _value_render(v, tmp);
+      tmp[n] = '\0';
+      if (list->flags & LIST_STRCACHE) {
+        *_value_cache(v) = strdup(tmp); }
+    }
+
+    if (len == 0) {
+        return ERANGE; }
+    if (n >= len) {
+      memcpy(buf, s, len - 1);
+      buf[len - 1] = '\0';
+      return ERANGE;
+    }
+    memcpy(buf, s, n);
+    buf[n] = '\0';
+
+    return e;
+}
+
+#define ARENA_BLOCK 65536
+
+PRIVATE
+char* _arena_alloc(List* list, size_t len)
+{
+    Arena* a = list->arena;
+
+    if (!a || a->size - a->used < len) {
+      size_t size = (len > ARENA_BLOCK) ? len : ARENA_BLOCK;
+      a = (Arena*) malloc(sizeof(Arena) + size);
+      if (!a) {
+          return nullptr; }
+      a->next = list->arena;
+      atomic_init(&a->refs, 1);
+      a->used = 0;
+      a->size = size;
+      list->arena = a;
+    }
+
+    char* p = a->data + a->used;
+    a->used += len;
+
+    return p;
+}
+
+PRIVATE
+char* _arena_strndup(List* list, const char* s, size_t n)
+{
+    char* p = _arena_alloc(list, n + 1);
+    if (p) {
+      memcpy(p, s, n);
+      p[n] = '\0';
+    }
+
+    return p;
+}
+
+ // values moving to another list take their strings along
+PRIVATE
+void _arena_adopt(List* list, Arena* arena)
+{
+    if (!arena) {
+        return; }
+
+    Arena* tail = arena;
+    while (tail->next) {
+      tail = tail->next; }
+    tail->next = list->arena;
+    list->arena = arena;
+}
+
+PRIVATE
+void _arena_release(Arena* a)
+{
+    if (atomic_fetch_sub(&a->refs, 1) == 1) {
+      free(a); }
+}
+
+PRIVATE
+void _arena_free(List* list)
+{
+    while (list->arena) {
+      Arena* next = list->arena->next;
+      _arena_release(list->arena);
+      list->arena = next;
+    }
+}
+
+ // the list takes a long blob: its bytes get copied into the arena, as a
+ // record LIST_COMPACT payloads can point to (lock held)
+PRIVATE
+bool _value_own(List* list, Value* v)
+{
+    if (!_value_long_blob(v)) {
+        return true; }
+
+    char* rec = _arena_alloc(list, BLOB_HEADER + v->n);
+    if (!rec) {
+        return false; }
+    memcpy(rec, &v->n, BLOB_HEADER);
+    memcpy(rec + BLOB_HEADER, v->p, v->n);
+    v->p = (const uint8_t*)rec + BLOB_HEADER;
+
+    return true;
+}
+
+PRIVATE
+Frozen* _frozen_create(uint8_t* tags, Payload* data)
+{
+    Frozen* f = (Frozen*) malloc(sizeof(Frozen));
+    if (!f) {
+        return nullptr; }
+
+    atomic_init(&f->refs, 1);
+    f->tags = tags;
+    f->data = data;
+    f->lo = SIZE_MAX;
+    f->hi = 0;
+    f->held = nullptr;
+    f->held_count = 0;
+
+    return f;
+}
+
+ // on each snapshot: all arena blocks of the list (a superset of those held
+ // before, as arenas only grow), kept until the last one out
+PRIVATE
+bool _frozen_hold(Frozen* f, Arena* chain)
+{
+    size_t n = 0;
+    for (Arena* a = chain; a != nullptr; a = a->next) {
+      n++; }
+    if (n == 0) {
+        return true; }
+    Arena** held = (Arena**) malloc(n * sizeof(Arena*));
+    if (!held) {
+        return false; }
+
+    n = 0;
+    for (Arena* a = chain; a != nullptr; a = a->next) {
+      atomic_fetch_add(&a->refs, 1);
+      held[n++] = a;
+    }
+    for (size_t k = 0; k < f->held_count; k++) {
+      _arena_release(f->held[k]); }
+    free(f->held);
+    f->held = held;
+    f->held_count = n;
+
+    return true;
+}
+
+PRIVATE
+void _frozen_release(Frozen* f)
+{
+    if (atomic_fetch_sub(&f->refs, 1) == 1)
+    {   for (size_t k = 0; k < f->held_count; k++) {
+          _arena_release(f->held[k]); }
+        free(f->held);
+        free(f->tags);
+        free(f->data);
+        free(f); }
+}
+
+ // LIST_COMPACT allocations, or our share of them
+PRIVATE
+void _store_free(Frozen* f, uint8_t* tags, Payload* data)
+{
+    if (f) {
+      _frozen_release(f);
+    } else {
+      free(tags);
+      free(data);
+    }
+}
+
+ // before positions [from,to) get written: copies arrays shared with
+ // snapshots (to "cap" slots) if they see any of these, or must grow
+PRIVATE
+bool _store_thaw(List* list, ptrdiff_t from, ptrdiff_t to, size_t cap)
+{
+    Frozen* f = list->frozen;
+    ptrdiff_t at = (ptrdiff_t)list->gap;      // slot of position 0
+    if (!f || (cap == list->capacity && (from >= to ||
+        at + to <= (ptrdiff_t)f->lo || at + from >= (ptrdiff_t)f->hi))) {
+        return true; }
+
+    size_t gap = list->gap;
+    uint8_t* tags = (uint8_t*) malloc(gap + cap);
+    Payload* data = (Payload*) malloc((gap + cap) * sizeof(Payload));
+    if (!tags || !data)
+    {   free(tags); free(data);
+        return false; }
+    memcpy(tags + gap, list->tags, list->length);
+    memcpy(data + gap, list->data, list->length * sizeof(Payload));
+
+    _frozen_release(f);
+    list->frozen = nullptr;
+    list->tags = tags + gap;
+    list->data = data + gap;
+    list->capacity = cap;
+    return true;
+}
+
+PRIVATE
+bool _store_reserve(List* list, size_t n)
+{
+    if (list->length + n <= list->capacity) {
+        return _store_thaw(list, list->length, list->length + n, list->capacity); }
+
+    // slide back over the front gap, when that at least doubles the room
+    if (list->gap && list->gap >= list->length && !list->frozen)
+    { uint8_t* tags = list->tags - list->gap;
+      Payload* data = list->data - list->gap;
+      memmove(tags, list->tags, list->length);
+      memmove(data, list->data, list->length * sizeof(Payload));
+      list->tags = tags;
+      list->data = data;
+      list->capacity += list->gap;
+      list->gap = 0;
+      if (list->length + n <= list->capacity) {
+          return true; }
+    }
+
+    size_t cap = list->capacity ? list->capacity : 16;
+    while (cap < list->length + n) {
+      cap *= 2; }
+    if (list->frozen) {
+        return _store_thaw(list, 0, 0, cap); }   // a copy grows as well
+
+    // grow geometrically, both arrays keep the same capacity (and gap)
+    size_t gap = list->gap;
+    uint8_t* tags = (uint8_t*) realloc(gap ? list->tags - gap : list->tags, gap + cap);
+    if (tags) {
+      list->tags = tags + gap; }
+    Payload* data = (Payload*) realloc(gap ? list->data - gap : list->data,
+                                       (gap + cap) * sizeof(Payload));
+    if (data) {
+      list->data = data + gap; }
+    if (!tags || !data) {
+        return false; }
+
+    list->capacity = cap;
+    return true;
+}
+
+ // tag and payload of a value the list owns (strings stay pointers)
+PRIVATE
+uint8_t _payload_encode(const Value* v, Payload* p)
+{
+    if (v->t != T_BLOB) {
+      memcpy((void*)p, (void*)&v->f, sizeof(Payload));
+      return (uint8_t)v->t;
+    }
+    if (v->n <= BLOB_INLINE) {
+      memcpy(p->c, v->c, sizeof(Payload));
+      p->c[BLOB_INLINE] = (char)v->n;
+      return T_SBLOB;
+    }
+    p->s = (char*)(v->p - BLOB_HEADER);
+    return T_BLOB;
+}
+
+PRIVATE
+void _store_put(List* list, size_t pos, const Value* v)
+{
+    Payload* p = &list->data[pos];
+
+    if (v->t == T_STRING && v->s && strlen(v->s) < sizeof(Payload)) {
+      list->tags[pos] = T_SSTR;
+      strncpy(p->c, v->s, sizeof(Payload));
+    } else {
+      list->tags[pos] = _payload_encode(v, p);
+    }
+}
+
+PRIVATE
+void _payload_decode(List* list, uint8_t tag, const Payload* p, Value* v)
+{
+    if (tag == T_SSTR) {
+      v->t = T_STRING;
+      v->s = (char*)p->c; // valid until the list changes
+    } else if (tag == T_STRING && list->heap) {
+      uint64_t off;       // mapped list
+      memcpy(&off, p, sizeof(off));
+      v->t = T_STRING;
+      v->s = (off < list->heap_size) ? (char*)list->heap + off : nullptr;
+    } else if (tag == T_SBLOB) {
+      v->t = T_BLOB;
+      v->n = (uint8_t)p->c[BLOB_INLINE];
+      memcpy(v->c, p->c, sizeof(Payload));
+      v->c[BLOB_INLINE] = 0;
+    } else if (tag == T_BLOB) {
+      const uint8_t* rec = (const uint8_t*)p->s;
+      uint32_t n = 0;
+      if (list->heap)
+      { uint64_t off;     // mapped list: checked against its heap
+        memcpy(&off, p, sizeof(off));
+        rec = (off < list->heap_size && list->heap_size - off >= BLOB_HEADER)
+            ? (const uint8_t*)list->heap + off : nullptr;
+        if (rec) {
+          memcpy(&n, rec, BLOB_HEADER); }
+        if (rec && n > list->heap_size - off - BLOB_HEADER) {
+          n = 0; }
+      } else {
+        memcpy(&n, rec, BLOB_HEADER);
+      }
+      v->t = T_BLOB;
+      v->n = n;
+      if (n > BLOB_INLINE) {
+        v->p = rec + BLOB_HEADER; }
+      else
+      { memset(v->c, 0, sizeof(v->c));
+        if (n) {
+          memcpy(v->c, rec + BLOB_HEADER, n); } }
+    } else {
+      v->t = (ValueType)tag;
+      memcpy((void*)&v->f, (void*)p, sizeof(Payload));
+    }
+}
+
+PRIVATE
+void _store_get(List* list, size_t pos, Value* v)
+{
+    _payload_decode(list, list->tags[pos], &list->data[pos], v);
+}
+
+PRIVATE
+void _store_move(List* list, size_t from, size_t to)
+{
+    size_t n = list->length - from;
+
+    memmove(&list->tags[to], &list->tags[from], n);
+    memmove(&list->data[to], &list->data[from], n * sizeof(Payload));
+}
+
+ // the "n" first slots moved by "delta" (+1/-1) instead, over the front gap
+PRIVATE
+void _store_move_front(List* list, size_t n, ptrdiff_t delta)
+{
+    memmove(&list->tags[delta], &list->tags[0], n);
+    memmove(&list->data[delta], &list->data[0], n * sizeof(Payload));
+
+    list->tags += delta;
+    list->data += delta;
+    list->capacity -= delta;
+    list->gap += delta;
+}
+
+ // linked lists: from the nearest end
+PRIVATE
+Value* _list_node(List* list, size_t idx)
+{
+    Value* c;
+
+    if (idx < list->length / 2) {
+      c = list->first;
+      for (typeof(idx) i = 0; i < idx; i++) { // C23
+        c = c->next; }
+    } else {
+      c = list->last;
+      for (typeof(idx) i = list->length - 1; i > idx; i--) { // C23
+        c = c->prev; }
+    }
+
+    return c;
+}
+
+ // linked lists: the nodes from "next" on moved by "delta" (+1/-1), "pos"
+ // ones being before them; node "idx" fields are positions plus "origin",
+ // so moving "origin" instead re-indexes all nodes: only the shorter side
+ // is walked, and both ends are O(1)
+PRIVATE
+void _list_reindex(List* list, size_t pos, Value* prev, Value* next, ptrdiff_t delta)
+{
+    if (pos < list->length / 2) {
+      list->origin -= delta;
+      for (Value* c = prev; c != nullptr; c = c->prev) {
+        c->idx -= delta; }
+    } else {
+      for (Value* c = next; c != nullptr; c = c->next) {
+        c->idx += delta; }
+    }
+}
+
+PRIVATE
+Value* _list_seek(List* list, Cursor* c, size_t idx)
+{
+    c->idx = idx;
+
+    if (list->flags & LIST_COMPACT) {
+      _store_get(list, idx, &c->scratch);
+      return c->node = &c->scratch;
+    }
+
+    return c->node = _list_node(list, idx);
+}
+
+ // caller ensures there is a next value
+PRIVATE
+Value* _list_step(List* list, Cursor* c)
+{
+    c->idx++;
+
+    if (list->flags & LIST_COMPACT) {
+      _store_get(list, c->idx, &c->scratch);
+      return c->node;
+    }
+
+    return c->node = c->node->next;
+}
+
+// INDEX (value -> position, kept in sync by every add/del below)
+
+PRIVATE
+uint64_t _value_hash(const Value* v)
+{
+    uint64_t h = 0;
+
+    switch (v->t) {
+      case T_INTEGER: h = (uint64_t)(int64_t)v->i; break;
+      case T_BOOLEAN: h = v->b;                    break;
+      case T_FLOAT  : { double f = (v->f == 0.0) ? 0.0 : v->f; // -0 == 0
+                        memcpy(&h, &f, sizeof(h)); }           break;
+      case T_STRING : h = 14695981039346656037ULL;             // FNV-1a
+                      for (const char* c = v->s; c && *c; c++) {
+                        h = (h ^ (uint8_t)*c) * 1099511628211ULL; }
+                      break;
+      case T_INT64  : h = (uint64_t)v->l;                      break;
+      case T_BLOB   : h = 14695981039346656037ULL;
+                      for (uint32_t k = 0; k < v->n; k++) {
+                        h = (h ^ _value_bytes(v)[k]) * 1099511628211ULL; }
+                      break;
+      default       : break;
+    }
+
+    // mix the type in, then spread the bits (splitmix64 finalizer)
+    h ^= (uint64_t)v->t << 59;
+    h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    h = (h ^ (h >> 27)) * 0x94d049bb133111ebULL;
+    return h ^ (h >> 31);
+}
+
+PRIVATE
+bool _value_equal(const Value* a, const Value* b)
+{
+    if (a->t != b->t) {
+        return false; }
+
+    switch (a->t) {
+      case T_INTEGER: return a->i == b->i;
+      case T_BOOLEAN: return a->b == b->b;
+      case T_FLOAT  : return a->f == b->f;
+      case T_STRING : return (a->s && b->s) ? !strcmp(a->s, b->s)
+                                            : (a->s == b->s);
+      case T_INT64  : return a->l == b->l;
+      case T_BLOB   : return (a->n == b->n) &&
+                             !memcmp(_value_bytes(a), _value_bytes(b), a->n);
+      default       : return false;
+    }
+}
+
+ // the value an entry points to ("scratch" receives LIST_COMPACT ones)
+PRIVATE
+Value* _index_value(List* list, const IndexEntry* e, Value* scratch)
+{
+    if (list->flags & LIST_COMPACT) {
+      _store_get(list, e->slot - list->origin, scratch);
+      return scratch;
+    }
+
+    return e->node;
+}
+
+PRIVATE
+void _index_free(List* list)
+{
+    free(list->index.heads);
+    free(list->index.entries);
+    memset(&list->index, 0, sizeof(Index));
+}
+
+ // out of memory: the list forgets its index, and lookups scan again
+PRIVATE
+void _index_drop(List* list)
+{
+    _index_free(list);
+    list->flags &= ~LIST_HASHINDEX;
+}
+
+PRIVATE
+bool _index_reserve(List* list)
+{
+    Index* x = &list->index;
+
+    if (x->count == x->capacity) {
+      size_t cap = x->capacity ? x->capacity * 2 : 16;
+      IndexEntry* e = (IndexEntry*) realloc(x->entries, cap * sizeof(IndexEntry));
+      if (!e) {
+          return false; }
+      x->entries = e;
+      x->capacity = cap;
+    }
+
+    // keep at most 1 entry per bucket on average
+    if (x->heads == nullptr || x->count > x->mask) {
+      size_t n = x->heads ? (x->mask + 1) * 2 : 16;
+      size_t* heads = (size_t*) malloc(n * sizeof(size_t));
+      if (!heads) {
+          return false; }
+      for (size_t b = 0; b < n; b++) {
+        heads[b] = INDEX_NIL; }
+      for (size_t k = 0; k < x->count; k++) {
+        size_t* head = &heads[x->entries[k].hash & (n - 1)];
+        x->entries[k].next = *head;
+        *head = k;
+      }
+      free(x->heads);
+      x->heads = heads;
+      x->mask = n - 1;
+    }
+
+    return true;
+}
+
+ // "node" for linked lists, "pos" for LIST_COMPACT ones
+PRIVATE
+void _index_insert(List* list, size_t pos, Value* node)
+{
+    if (!(list->flags & LIST_HASHINDEX)) {
+        return; }
+    if (!_index_reserve(list)) {
+        _index_drop(list); return; }
+
+    Index* x = &list->index;
+    IndexEntry* e = &x->entries[x->count];
+
+    if (list->flags & LIST_COMPACT) { e->slot = pos + list->origin; }
+    else                            { e->node = node; }
+
+    Value scratch;
+    e->hash = _value_hash(_index_value(list, e, &scratch));
+    e->next = x->heads[e->hash & x->mask];
+    x->heads[e->hash & x->mask] = x->count++;
+}
+
+ // called before the value itself leaves the list
+PRIVATE
+void _index_remove(List* list, size_t pos, Value* node)
+{
+    if (!(list->flags & LIST_HASHINDEX) || list->index.heads == nullptr) {
+        return; }
+
+    Index* x = &list->index;
+    bool compact = (list->flags & LIST_COMPACT);
+    Value scratch;
+    Value* v = compact ? (_store_get(list, pos, &scratch), &scratch) : node;
+    uint64_t hash = _value_hash(v);
+
+    // unlink our entry from its bucket
+    size_t* link = &x->heads[hash & x->mask];
+    while (*link != INDEX_NIL) {
+      IndexEntry* e = &x->entries[*link];
+      if (compact ? (e->slot - list->origin == pos) : (e->node == node)) {
+        break; }
+      link = &e->next;
+    }
+    if (*link == INDEX_NIL) {
+        return; }
+    size_t k = *link;
+    *link = x->entries[k].next;
+
+    // keep entries dense: the last one takes the free place
+    size_t last = --x->count;
+    if (k != last) {
+      link = &x->heads[x->entries[last].hash & x->mask];
+      while (*link != last) {
+        link = &x->entries[*link].next; }
+      *link = k;
+      x->entries[k] = x->entries[last];
+    }
+}
+
+ // LIST_COMPACT slots from "from" moved by "delta" (none or all: O(1))
+PRIVATE
+void _index_shift(List* list, size_t from, ptrdiff_t delta)
+{
+    if (!(list->flags & LIST_HASHINDEX) || !(list->flags & LIST_COMPACT)) {
+        return; }
+    if (from == 0)
+    {   list->origin -= delta;
+        return; }
+    if (from >= list->index.count) {
+        return; }   // entries hold positions 0...count-1
+
+    for (size_t k = 0; k < list->index.count; k++) {
+      IndexEntry* e = &list->index.entries[k];
+      if (e->slot - list->origin >= from) {
+        e->slot += delta; }
+    }
+}
+
+ // LIST_COMPACT slots all moved
+PRIVATE
+void _index_rebuild(List* list)
+{
+    _index_free(list);
+    Value* c = list->first;   // (nullptr for LIST_COMPACT)
+    for (size_t pos = 0; pos < list->length; pos++, c = c ? c->next : nullptr) {
+      _index_insert(list, pos, c); }
+}
+
+ // first position holding "key", if any
+PRIVATE
+bool _index_find(List* list, const Value* key, size_t* idx)
+{
+    Index* x = &list->index;
+    if (x->heads == nullptr) {
+        return false; }
+
+    uint64_t hash = _value_hash(key);
+    bool found = false;
+    Value scratch;
+
+    for (size_t k = x->heads[hash & x->mask]; k != INDEX_NIL; k = x->entries[k].next)
+    { IndexEntry* e = &x->entries[k];
+      if (e->hash != hash || !_value_equal(_index_value(list, e, &scratch), key)) {
+        continue; }
+      size_t pos = (list->flags & LIST_COMPACT) ? e->slot : e->node->idx;
+      pos -= list->origin;
+      if (!found || pos < *idx) {
+        *idx = pos; }
+      found = true;
+    }
+
+    return found;
+}
+
+// WAITING (timed waits, change notifications)
+
+ // "timeout" microseconds from now, as C11 timed waits want it
+PRIVATE
+void _deadline(struct timespec* ts, unsigned int timeout)
+{
+    timespec_get(ts, TIME_UTC);           // C11,C23
+    ts->tv_sec += timeout / 1000000;
+    ts->tv_nsec += (timeout % 1000000) * 1000;
+    if (ts->tv_nsec >= 1000000000) {
+      ts->tv_sec++;
+      ts->tv_nsec -= 1000000000; }
+}
+
+ // after each change (lock held): wakes "list_wait_length()" callers, runs
+ // watches; costs a load and a test when there are none
+PRIVATE
+void _list_notify(List* list)
+{
+    if (atomic_load_explicit(&list->waiters, memory_order_relaxed) > 0) {
+      cnd_broadcast(&list->changed); }
+
+    if (list->watch_count && !list->notifying)
+    { list->notifying = true;
+      for (size_t k = 0; k < list->watch_count; k++) {
+        list->watches[k].fn(list, list->length, list->watches[k].data); }
+      list->notifying = false;
+    }
+}
+
+
+// QUEUE (bounded MPMC ring after D. Vyukov: lock-free push and pop)
+
+#define QUEUE_SPIN 64     // tries before sleeping, when full or empty
+
+PRIVATE
+Queue* _queue_create(size_t capacity)
+{
+    size_t size = 2;
+    while (size < capacity) {
+      size <<= 1; }
+
+    Queue* q = (Queue*) calloc(1, sizeof(Queue));
+    if (!q) {
+        return nullptr; }
+    q->cells = (QueueCell*) malloc(size * sizeof(QueueCell));
+    if (!q->cells)
+    {   free(q);
+        return nullptr; }
+
+    // cell "k" is free for the push of ticket "k"
+    for (size_t k = 0; k < size; k++) {
+      atomic_init(&q->cells[k].seq, k); }
+    atomic_init(&q->head, 0);
+    atomic_init(&q->tail, 0);
+    atomic_init(&q->sleepers, 0);
+    q->mask = size - 1;
+    mtx_init(&q->lock, mtx_plain);
+    cnd_init(&q->changed);
+
+    return q;
+}
+
+PRIVATE
+void _queue_free(Queue* q)
+{
+    if (!q) {
+        return; }
+
+    cnd_destroy(&q->changed);
+    mtx_destroy(&q->lock);
+    free(q->cells);
+    free(q);
+}
+
+PRIVATE
+size_t _queue_length(Queue* q)
+{
+    size_t head = atomic_load_explicit(&q->head, memory_order_relaxed);
+    size_t tail = atomic_load_explicit(&q->tail, memory_order_relaxed);
+
+    return (tail > head) ? tail - head : 0;   // a guess, while others work
+}
+
+ // one try, false if full: take the "tail" ticket when its cell is free
+ // ("seq == ticket"), fill it, then hand it to the pop of that ticket
+PRIVATE
+bool _queue_try_push(Queue* q, Value* v)
+{
+    size_t pos = atomic_load_explicit(&q->tail, memory_order_relaxed);
+
+    for (;;) {
+      QueueCell* c = &q->cells[pos & q->mask];
+      size_t seq = atomic_load_explicit(&c->seq, memory_order_acquire);
+      ptrdiff_t dif = (ptrdiff_t)(seq - pos);
+      if (dif == 0) {
+        if (atomic_compare_exchange_weak_explicit(&q->tail, &pos, pos + 1,
+                      memory_order_relaxed, memory_order_relaxed)) {
+          c->v = *v;
+          atomic_store_explicit(&c->seq, pos + 1, memory_order_release);
+          return true; }
+      } else if (dif < 0) {
+        return false;     // not popped yet, one lap behind
+      } else {
+        pos = atomic_load_explicit(&q->tail, memory_order_relaxed);
+      }
+    }
+}
+
+ // one try, false if empty: the same, from the "head" ticket, handing the
+ // cell back to the push one lap later
+PRIVATE
+bool _queue_try_pop(Queue* q, Value* v)
+{
+    size_t pos = atomic_load_explicit(&q->head, memory_order_relaxed);
+
+    for (;;) {
+      QueueCell* c = &q->cells[pos & q->mask];
+      size_t seq = atomic_load_explicit(&c->seq, memory_order_acquire);
+      ptrdiff_t dif = (ptrdiff_t)(seq - (pos + 1));
+      if (dif == 0) {
+        if (atomic_compare_exchange_weak_explicit(&q->head, &pos, pos + 1,
+                      memory_order_relaxed, memory_order_relaxed)) {
+          *v = c->v;
+          atomic_store_explicit(&c->seq, pos + q->mask + 1, memory_order_release);
+          return true; }
+      } else if (dif < 0) {
+        return false;     // not pushed yet
+      } else {
+        pos = atomic_load_explicit(&q->head, memory_order_relaxed);
+      }
+    }
+}
+
+ // after a push or pop: wakes up threads waiting for one, if any
+PRIVATE
+void _queue_notify(Queue* q)
+{
+    // pairs with the one in "_queue_wait()": either they see our change,
+    // or we see them sleeping
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(&q->sleepers, memory_order_relaxed) > 0)
+    {   mtx_lock(&q->lock);
+        cnd_broadcast(&q->changed);
+        mtx_unlock(&q->lock); }
+}
+
+typedef bool (*QueueOp)(Queue* q, Value* v);
+
+ // "op" until it succeeds: spinning a little, then sleeping up to "timeout"
+PRIVATE
+errno_t _queue_wait(List* list, QueueOp op, Value* v)
+{
+    Queue* q = list->queue;
+    bool ok = op(q, v);
+
+    for (int k = 0; !ok && list->timeout && k < QUEUE_SPIN; k++) {
+      thrd_yield();
+      ok = op(q, v);
+    }
+
+    if (!ok && list->timeout) {
+      struct timespec ts;
+      _deadline(&ts, list->timeout);
+
+      mtx_lock(&q->lock);
+      atomic_fetch_add(&q->sleepers, 1);
+      atomic_thread_fence(memory_order_seq_cst);
+      while (!(ok = op(q, v))) {
+        if (cnd_timedwait(&q->changed, &q->lock, &ts) != thrd_success)
+        {   ok = op(q, v);
+            break; }
+      }
+      atomic_fetch_sub(&q->sleepers, 1);
+      mtx_unlock(&q->lock);
+    }
+
+    if (!ok) {
+        return errno = EAGAIN; }
+    _queue_notify(q);
+
+    return EXIT_SUCCESS;
+}
+
+#define _queue_push(L, V) _queue_wait(L, _queue_try_push, V)
+#define _queue_pop(L, V)  _queue_wait(L, _queue_try_pop, V)
+
+
+// POOL (worker threads shared by all lists, started by the first parallel job)
+
+#define POOL_THREADS_MAX 16
+
+typedef void (*PoolTask)(void* arg, size_t k);
+
+typedef struct
+{
+    mtx_t busy;           // one job at a time
+    mtx_t lock;
+    cnd_t wake;           // a job got posted
+    cnd_t idle;           // its last task is done
+
+    size_t size;          // workers + the caller
+
+    PoolTask task;        // current job: tasks [0,count)
+    void* arg;
+    size_t next;
+    size_t count;
+    size_t running;
+} Pool;
+
+static Pool _pool;
+static once_flag _pool_once = ONCE_FLAG_INIT;
+
+PRIVATE
+size_t _cpu_count(void)
+{
+#ifdef _WIN32
+    SYSTEM_INFO si;
+    GetSystemInfo(&si);
+    long n = (long)si.dwNumberOfProcessors;
+#else
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+    return (n < 1) ? 1 : (n > POOL_THREADS_MAX) ? POOL_THREADS_MAX : (size_t)n;
+}
+
+PRIVATE
+int _pool_worker(void*)
+{
+    mtx_lock(&_pool.lock);
+
+    for (;;) {
+      while (_pool.next >= _pool.count) {
+        cnd_wait(&_pool.wake, &_pool.lock); }
+      PoolTask task = _pool.task;
+      void* arg = _pool.arg;
+      size_t k = _pool.next++;
+      _pool.running++;
+      mtx_unlock(&_pool.lock);
+
+      task(arg, k);
+
+      mtx_lock(&_pool.lock);
+      if (--_pool.running == 0 && _pool.next >= _pool.count) {
+        cnd_broadcast(&_pool.idle); }
+    }
+
+    return 0;
+}
+
+PRIVATE
+void _pool_start(void)
+{
+    mtx_init(&_pool.busy, mtx_plain);
+    mtx_init(&_pool.lock, mtx_plain);
+    cnd_init(&_pool.wake);
+    cnd_init(&_pool.idle);
+
+    // workers live as long as the process
+    _pool.size = 1;
+    for (size_t t = 1; t < _cpu_count(); t++) {
+      thrd_t thr;
+      if (thrd_create(&thr, _pool_worker, nullptr) != thrd_success) {
+        break; }
+      thrd_detach(thr);
+      _pool.size++;
+    }
+}
+
+PRIVATE
+size_t _pool_size(void)
+{
+    call_once(&_pool_once, _pool_start);
+
+    return _pool.size;
+}
+
+ // runs "task(arg, 0...count-1)" and returns when all are done
+PRIVATE
+void _pool_run(PoolTask task, void* arg, size_t count)
+{
+    // small job, no worker, or pool busy with another list: do it here
+    if (count < 2 || _pool_size() < 2 || mtx_trylock(&_pool.busy) != thrd_success) {
+      for (size_t k = 0; k < count; k++) {
+        task(arg, k); }
+      return;
+    }
+
+    mtx_lock(&_pool.lock);
+    _pool.task = task;
+    _pool.arg = arg;
+    _pool.next = 0;
+    _pool.count = count;
+    cnd_broadcast(&_pool.wake);
+
+    // the caller takes tasks too
+    while (_pool.next < _pool.count) {
+      size_t k = _pool.next++;
+      _pool.running++;
+      mtx_unlock(&_pool.lock);
+      task(arg, k);
+      mtx_lock(&_pool.lock);
+      _pool.running--;
+    }
+    while (_pool.running > 0) {
+      cnd_wait(&_pool.idle, &_pool.lock); }
+
+    mtx_unlock(&_pool.lock);
+    mtx_unlock(&_pool.busy);
+}
+
+
+// SORT (on an array of items, chunks sorted then merged in parallel)
+
+#define SORT_RUN 16               // insertion sort below
+#define SORT_PARALLEL_MIN 32768   // values, before the pool gets involved
+
+ // the built-in order (nullptr "cmp") gets inlined, and mostly decided by keys
+#define _sort_cmp(C, A, B) ((C) ? (C)((A).v, (B).v) : _item_compare(&(A), &(B)))
+
+typedef struct
+{
+    uint64_t key;         // ordered like the value within its rank
+    ValueType rank;
+    Value* v;
+} SortItem;
+
+ // ints and int64s rank as one type, ordered by value
+#define _value_rank(T) (((T) == T_INT64) ? T_INTEGER : (T))
+#define _value_wide(V) (((V)->t == T_INT64) ? (V)->l : (int64_t)(V)->i)
+
+PRIVATE
+int _value_compare(const Value* a, const Value* b)
+{
+    // by type first, then by value
+    ValueType ra = _value_rank(a->t), rb = _value_rank(b->t);
+    if (ra != rb) {
+        return (ra < rb) ? -1 : 1; }
+
+    switch (ra) {
+      case T_INTEGER: { int64_t x = _value_wide(a), y = _value_wide(b);
+                        return (x > y) - (x < y); }
+      case T_BOOLEAN: return (a->b > b->b) - (a->b < b->b);
+      case T_FLOAT  : if (isnan(a->f) || isnan(b->f)) {  // NaN last
+                        return (bool)isnan(a->f) - (bool)isnan(b->f); }
+                      return (a->f > b->f) - (a->f < b->f);
+      case T_STRING : if (!a->s || !b->s) {              // nullptr first
+                        return (a->s != nullptr) - (b->s != nullptr); }
+                      { int c = strcmp(a->s, b->s);
+                        return (c > 0) - (c < 0); }
+      case T_BLOB   : { int c = memcmp(_value_bytes(a), _value_bytes(b),
+                                       (a->n < b->n) ? a->n : b->n);
+                        if (c == 0) {                    // shorter first
+                          return (a->n > b->n) - (a->n < b->n); }
+                        return (c > 0) - (c < 0); }
+      default       : return 0;
+    }
+}
+
+PRIVATE
+void _item_set(SortItem* it, Value* v)
+{
+    uint64_t key = 0;
+
+    switch (v->t) {
+      case T_INTEGER: key = (uint64_t)(int64_t)v->i ^ (1ULL << 63); break;
+      case T_BOOLEAN: key = v->b;                                   break;
+      case T_FLOAT  : if (isnan(v->f)) {
+                        key = UINT64_MAX; break; }
+                      { double f = (v->f == 0.0) ? 0.0 : v->f;      // -0 == 0
+                        memcpy(&key, &f, sizeof(key));
+                        key = (key >> 63) ? ~key : key | (1ULL << 63); }
+                      break;
+      case T_STRING : // first 8 bytes, big-endian, like "strcmp()" sees them
+                      for (size_t k = 0; v->s && k < 8 && v->s[k]; k++) {
+                        key |= (uint64_t)(uint8_t)v->s[k] << (56 - 8 * k); }
+                      break;
+      case T_INT64  : key = (uint64_t)v->l ^ (1ULL << 63);          break;
+      case T_BLOB   : for (size_t k = 0; k < 8 && k < v->n; k++) {  // likewise
+                        key |= (uint64_t)_value_bytes(v)[k] << (56 - 8 * k); }
+                      break;
+      default       : break;
+    }
+
+    it->key = key;
+    it->rank = _value_rank(v->t);
+    it->v = v;
+}
+
+PRIVATE
+int _item_compare(const SortItem* a, const SortItem* b)
+{
+    if (a->rank != b->rank) {
+        return (a->rank < b->rank) ? -1 : 1; }
+    if (a->key != b->key) {
+        return (a->key < b->key) ? -1 : 1; }
+
+    // same 8-byte prefix: only strings and blobs need a closer look
+    return (a->rank == T_STRING || a->rank == T_BLOB) ? _value_compare(a->v, b->v) : 0;
+}
+
+PRIVATE
+void _sort_insertion(SortItem* a, size_t n, ListCompare cmp)
+{
+    for (size_t i = 1; i < n; i++) {
+      SortItem v = a[i];
+      size_t j = i;
+      for (; j > 0 && _sort_cmp(cmp, a[j-1], v) > 0; j--) {
+        a[j] = a[j-1]; }
+      a[j] = v;
+    }
+}
+
+ // stable: equal values taken from "l" first
+PRIVATE
+void _sort_merge_runs(SortItem* l, size_t nl, SortItem* r, size_t nr, SortItem* out, ListCompare cmp)
+{
+    size_t i = 0, j = 0, k = 0;
+
+    while (i < nl && j < nr) {
+      out[k++] = (_sort_cmp(cmp, r[j], l[i]) < 0) ? r[j++] : l[i++]; }
+    while (i < nl) {
+      out[k++] = l[i++]; }
+    while (j < nr) {
+      out[k++] = r[j++]; }
+}
+
+PRIVATE
+void _sort_merge(SortItem* a, SortItem* tmp, size_t n, ListCompare cmp)
+{
+    if (n <= SORT_RUN) {
+        _sort_insertion(a, n, cmp); return; }
+
+    size_t h = n / 2;
+    _sort_merge(a, tmp, h, cmp);
+    _sort_merge(a + h, tmp, n - h, cmp);
+    if (_sort_cmp(cmp, a[h-1], a[h]) <= 0) {
+        return; }   // already in order
+
+    // the right half is read ahead of where we write
+    memcpy(tmp, a, h * sizeof(SortItem));
+    _sort_merge_runs(tmp, h, a + h, n - h, a, cmp);
+}
+
+PRIVATE
+void _sort_quick(SortItem* a, size_t n, ListCompare cmp)
+{
+    while (n > SORT_RUN) {
+      // median of three as pivot
+      SortItem t;
+      size_t m = n / 2;
+      if (_sort_cmp(cmp, a[m], a[0]) < 0)   { t = a[m]; a[m] = a[0]; a[0] = t; }
+      if (_sort_cmp(cmp, a[n-1], a[m]) < 0) { t = a[m]; a[m] = a[n-1]; a[n-1] = t;
+        if (_sort_cmp(cmp, a[m], a[0]) < 0) { t = a[m]; a[m] = a[0]; a[0] = t; } }
+      SortItem p = a[m];
+
+      // Hoare partition: [0,j] <= p <= [j+1,n)
+      ptrdiff_t i = -1, j = (ptrdiff_t)n;
+      for (;;) {
+        do { i++; } while (_sort_cmp(cmp, a[i], p) < 0);
+        do { j--; } while (_sort_cmp(cmp, p, a[j]) < 0);
+        if (i >= j) {
+          break; }
+        t = a[i]; a[i] = a[j]; a[j] = t;
+      }
+
+      // recurse on the smaller side only
+      size_t left = (size_t)j + 1;
+      if (left < n - left) {
+        _sort_quick(a, left, cmp);
+        a += left; n -= left;
+      } else {
+        _sort_quick(a + left, n - left, cmp);
+        n = left;
+      }
+    }
+
+    _sort_insertion(a, n, cmp);
+}
+
+ // byte "b" of the key, the rank last
+#define _sort_digit(IT, B) (((B) < 8) ? (uint8_t)((IT).key >> (8 * (B))) \
+                                      : (uint8_t)(IT).rank)
+
+ // the built-in order only: LSD radix on (rank,key), stable
+PRIVATE
+void _sort_radix(SortItem* a, SortItem* tmp, size_t n)
+{
+    size_t count[9][256] = {{0}};
+
+    for (size_t i = 0; i < n; i++) {
+      for (int b = 0; b < 9; b++) {
+        count[b][_sort_digit(a[i], b)]++; }
+    }
+
+    SortItem* src = a;
+    SortItem* dst = tmp;
+    for (int b = 0; b < 9; b++) {
+      if (count[b][_sort_digit(src[0], b)] == n) {
+        continue; }   // same digit everywhere
+      size_t pos = 0;
+      for (int d = 0; d < 256; d++) {
+        size_t c = count[b][d];
+        count[b][d] = pos;
+        pos += c;
+      }
+      for (size_t i = 0; i < n; i++) {
+        dst[count[b][_sort_digit(src[i], b)]++] = src[i]; }
+      SortItem* t = src; src = dst; dst = t;
+    }
+    if (src != a) {
+      memcpy(a, src, n * sizeof(SortItem)); }
+
+    // strings (and blobs) sharing their first 8 bytes still need a closer look
+    for (size_t i = 0; i < n; ) {
+      size_t j = i + 1;
+      while (j < n && a[j].rank == a[i].rank && a[j].key == a[i].key) {
+        j++; }
+      if ((a[i].rank == T_STRING || a[i].rank == T_BLOB) && j - i > 1) {
+        _sort_merge(a + i, tmp, j - i, nullptr); }
+      i = j;
+    }
+}
+
+typedef struct
+{
+    SortItem* a;
+    SortItem* tmp;
+    size_t n;
+    size_t run;           // values per chunk, then per merged run
+    ListCompare cmp;
+    bool stable;
+} SortJob;
+
+PRIVATE
+void _sort_chunk_task(void* arg, size_t k)
+{
+    SortJob* j = (SortJob*) arg;
+    size_t from = k * j->run;
+    size_t n = (j->n - from < j->run) ? j->n - from : j->run;
+
+    if (!j->cmp)        { _sort_radix(j->a + from, j->tmp + from, n); }
+    else if (j->stable) { _sort_merge(j->a + from, j->tmp + from, n, j->cmp); }
+    else                { _sort_quick(j->a + from, n, j->cmp); }
+}
+
+ // merges runs "2k" and "2k+1" from "a" into "tmp"
+PRIVATE
+void _sort_merge_task(void* arg, size_t k)
+{
+    SortJob* j = (SortJob*) arg;
+    size_t from = 2 * k * j->run;
+    size_t mid = (j->n - from < j->run) ? j->n : from + j->run;
+    size_t end = (j->n - mid < j->run) ? j->n : mid + j->run;
+
+    _sort_merge_runs(j->a + from, mid - from, j->a + mid, end - mid,
+                     j->tmp + from, j->cmp);
+}
+
+ // returns "a" or "tmp", whichever ends up sorted
+PRIVATE
+SortItem* _sort_items(SortItem* a, SortItem* tmp, size_t n, ListCompare cmp, bool stable)
+{
+    size_t chunks = (n < SORT_PARALLEL_MIN) ? 1 : _pool_size();
+    SortJob j = { .a = a, .tmp = tmp, .n = n, .cmp = cmp, .stable = stable };
+
+    j.run = (n + chunks - 1) / chunks;
+    _pool_run(_sort_chunk_task, &j, (n + j.run - 1) / j.run);
+
+    for (; j.run < n; j.run *= 2) {
+      _pool_run(_sort_merge_task, &j, (n + 2 * j.run - 1) / (2 * j.run));
+      SortItem* t = j.a; j.a = j.tmp; j.tmp = t;
+    }
+
+    return j.a;
+}
+
+// PARALLEL (foreach/reduce: contiguous ranges spread over the pool)
+
+#define PARALLEL_MIN   16384  // values, before the pool gets involved
+#define PARALLEL_RANGE 4096   // values per range, at least
+
+typedef struct
+{
+    List* list;
+    ListForeach fn;       // either
+    ListReduce reduce;    // or
+    ListCombine combine;
+    void* ctx;
+
+    size_t ranges;
+    Value** starts;       // linked lists: first node of each range
+    uint8_t* accs;        // "reduce": one accumulator per range
+    size_t size;
+    atomic_bool changed;  // by "fn"
+} ParallelJob;
+
+ // range "k" is [k*length/ranges, (k+1)*length/ranges)
+PRIVATE
+void _parallel_range(void* arg, size_t k)
+{
+    ParallelJob* job = (ParallelJob*) arg;
+    List* list = job->list;
+    bool compact = (list->flags & LIST_COMPACT);
+    size_t from = k * list->length / job->ranges;
+    size_t to = (k + 1) * list->length / job->ranges;
+    Value* node = compact ? nullptr : job->starts[k];
+    void* acc = job->accs ? job->accs + k * job->size : nullptr;
+    bool changed = false;
+
+    for (size_t i = from; i < to; i++) {
+      Value scratch;
+      Value* v = node;
+      if (compact) {
+        _store_get(list, i, &scratch);
+        v = &scratch;
+      } else {
+        node = node->next;
+      }
+
+      if (job->reduce) {
+        job->reduce(acc, v, job->ctx);
+        continue; }
+
+      // write back what "fn" changed
+      Value was = *v;
+      job->fn(v, i, job->ctx);
+      if (v->t == was.t && memcmp(&v->f, &was.f, sizeof(Payload)) == 0) {
+        continue; }
+      changed = true;
+      if (compact) {
+        _store_put(list, i, v);
+      } else if (list->flags & LIST_STRCACHE) {
+        free(*_value_cache(v));
+        *_value_cache(v) = nullptr;
+      }
+    }
+
+    if (changed) {
+      atomic_store(&job->changed, true); }
+}
+
+
+// COLUMNS (aggregates run on contiguous tag/payload arrays, SIMD when possible)
+
+#define COLUMN_CHUNK 256
+
+typedef bool (*ColumnFunc)(List* list, const uint8_t* tags, const Payload* data,
+                           size_t n, size_t base, void* ctx);
+
+ // LIST_COMPACT arrays are passed as they are, nodes get gathered by chunks;
+ // stops when "fn" returns false
+PRIVATE
+void _list_columns(List* list, ColumnFunc fn, void* ctx)
+{
+    if (list->flags & LIST_COMPACT) {
+      fn(list, list->tags, list->data, list->length, 0, ctx);
+      return;
+    }
+
+    uint8_t tags[COLUMN_CHUNK];
+    Payload data[COLUMN_CHUNK];
+    size_t base = 0;
+
+    for (Value* c = list->first; c != nullptr; ) {
+      size_t n = 0;
+      for (; c != nullptr && n < COLUMN_CHUNK; c = c->next, n++) {
+        tags[n] = _payload_encode(c, &data[n]); }
+      if (!fn(list, tags, data, n, base, ctx)) {
+        return; }
+      base += n;
+    }
+}
+
+ // sum of FLOAT payloads, returns how many values were not FLOAT
+PRIVATE
+size_t _kernel_sum_float_scalar(const uint8_t* tags, const Payload* data, size_t n, double* sum)
+{
+    double s = 0.0;
+    size_t others = 0;
+
+    for (size_t i = 0; i < n; i++) {
+      if (tags[i] == T_FLOAT) { s += data[i].f; }
+      else                    { others++; }
+    }
+
+    *sum = s;
+    return others;
+}
+
+ // minimum/maximum of INTEGER payloads, returns how many values were not INTEGER
+PRIVATE
+size_t _kernel_minmax_int_scalar(const uint8_t* tags, const Payload* data, size_t n, int* min, int* max)
+{
+    size_t others = 0;
+
+    for (size_t i = 0; i < n; i++) {
+      if (tags[i] != T_INTEGER) {
+        others++; continue; }
+      if (data[i].i < *min) { *min = data[i].i; }
+      if (data[i].i > *max) { *max = data[i].i; }
+    }
+
+    return others;
+}
+
+ // count of tags equal to "a" or "b"
+PRIVATE
+size_t _kernel_count_tag_scalar(const uint8_t* tags, size_t n, uint8_t a, uint8_t b)
+{
+    size_t count = 0;
+
+    for (size_t i = 0; i < n; i++) {
+      count += (tags[i] == a || tags[i] == b); }
+
+    return count;
+}
+
+ // position of the first INTEGER payload equal to "x", or "n"
+PRIVATE
+size_t _kernel_find_int_scalar(const uint8_t* tags, const Payload* data, size_t n, int x)
+{
+    for (size_t i = 0; i < n; i++) {
+      if (tags[i] == T_INTEGER && data[i].i == x) {
+          return i; }
+    }
+
+    return n;
+}
+
+#ifdef __SSE2__
+PRIVATE
+size_t _kernel_sum_float_sse2(const uint8_t* tags, const Payload* data, size_t n, double* sum)
+{
+    __m128d acc = _mm_setzero_pd();
+    size_t i = 0, floats = 0;
+
+    for (; i + 2 <= n; i += 2) {
+      bool f0 = (tags[i] == T_FLOAT), f1 = (tags[i+1] == T_FLOAT);
+      __m128d m = _mm_castsi128_pd(_mm_set_epi64x(-(int64_t)f1, -(int64_t)f0));
+      acc = _mm_add_pd(acc, _mm_and_pd(_mm_loadu_pd(&data[i].f), m));
+      floats += f0 + f1;
+    }
+
+    double lanes[2], rest;
+    _mm_storeu_pd(lanes, acc);
+    size_t others = _kernel_sum_float_scalar(tags + i, data + i, n - i, &rest);
+
+    *sum = lanes[0] + lanes[1] + rest;
+    return (i - floats) + others;
+}
+
+PRIVATE
+size_t _kernel_count_tag_sse2(const uint8_t* tags, size_t n, uint8_t a, uint8_t b)
+{
+    const __m128i va = _mm_set1_epi8((char)a), vb = _mm_set1_epi8((char)b);
+    size_t i = 0, count = 0;
+
+    for (; i + 16 <= n; i += 16) {
+      __m128i t = _mm_loadu_si128((const __m128i*)&tags[i]);
+      __m128i m = _mm_or_si128(_mm_cmpeq_epi8(t, va), _mm_cmpeq_epi8(t, vb));
+      count += __builtin_popcount(_mm_movemask_epi8(m));
+    }
+
+    return count + _kernel_count_tag_scalar(tags + i, n - i, a, b);
+}
+#endif
+
+#ifdef SIMD_X86
+ // 4 payloads per step, tags widened to 64-bit lane masks
+PRIVATE AVX2
+size_t _kernel_sum_float_avx2(const uint8_t* tags, const Payload* data, size_t n, double* sum)
+{
+    const __m256i ft = _mm256_set1_epi64x(T_FLOAT);
+    __m256d acc = _mm256_setzero_pd();
+    size_t i = 0, floats = 0;
+
+    for (; i + 4 <= n; i += 4) {
+      int32_t t;
+      memcpy(&t, &tags[i], sizeof(t));
+      __m256i m = _mm256_cmpeq_epi64(_mm256_cvtepu8_epi64(_mm_cvtsi32_si128(t)), ft);
+      acc = _mm256_add_pd(acc, _mm256_and_pd(_mm256_loadu_pd(&data[i].f), _mm256_castsi256_pd(m)));
+      floats += __builtin_popcount(_mm256_movemask_pd(_mm256_castsi256_pd(m)));
+    }
+
+    double lanes[4], rest;
+    _mm256_storeu_pd(lanes, acc);
+    size_t others = _kernel_sum_float_scalar(tags + i, data + i, n - i, &rest);
+
+    *sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]) + rest;
+    return (i - floats) + others;
+}
+
+ // the low 32 bits of 8 payloads, packed in one vector
+PRIVATE AVX2
+__m256i _avx2_load_ints(const Payload* data)
+{
+    const __m256i low = _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7);
+    __m256i a = _mm256_permutevar8x32_epi32(_mm256_loadu_si256((const __m256i*)&data[0]), low);
+    __m256i b = _mm256_permutevar8x32_epi32(_mm256_loadu_si256((const __m256i*)&data[4]), low);
+
+    return _mm256_permute2x128_si256(a, b, 0x20);
+}
+
+PRIVATE AVX2
+__m256i _avx2_tag_mask(const uint8_t* tags, uint8_t tag)
+{
+    __m256i t = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)tags));
+    return _mm256_cmpeq_epi32(t, _mm256_set1_epi32(tag));
+}
+
+PRIVATE AVX2
+size_t _kernel_minmax_int_avx2(const uint8_t* tags, const Payload* data, size_t n, int* min, int* max)
+{
+    __m256i vmin = _mm256_set1_epi32(*min), vmax = _mm256_set1_epi32(*max);
+    const __m256i hi = _mm256_set1_epi32(INT_MAX), lo = _mm256_set1_epi32(INT_MIN);
+    size_t i = 0, ints = 0;
+
+    for (; i + 8 <= n; i += 8) {
+      __m256i v = _avx2_load_ints(&data[i]);
+      __m256i m = _avx2_tag_mask(&tags[i], T_INTEGER);
+      vmin = _mm256_min_epi32(vmin, _mm256_blendv_epi8(hi, v, m));
+      vmax = _mm256_max_epi32(vmax, _mm256_blendv_epi8(lo, v, m));
+      ints += __builtin_popcount(_mm256_movemask_ps(_mm256_castsi256_ps(m)));
+    }
+
+    int lanes_min[8], lanes_max[8];
+    _mm256_storeu_si256((__m256i*)lanes_min, vmin);
+    _mm256_storeu_si256((__m256i*)lanes_max, vmax);
+    for (int l = 0; l < 8; l++) {
+      if (lanes_min[l] < *min) { *min = lanes_min[l]; }
+      if (lanes_max[l] > *max) { *max = lanes_max[l]; }
+    }
+
+    return (i - ints) + _kernel_minmax_int_scalar(tags + i, data + i, n - i, min, max);
+}
+
+PRIVATE AVX2
+size_t _kernel_count_tag_avx2(const uint8_t* tags, size_t n, uint8_t a, uint8_t b)
+{
+    const __m256i va = _mm256_set1_epi8((char)a), vb = _mm256_set1_epi8((char)b);
+    size_t i = 0, count = 0;
+
+    for (; i + 32 <= n; i += 32) {
+      __m256i t = _mm256_loadu_si256((const __m256i*)&tags[i]);
+      __m256i m = _mm256_or_si256(_mm256_cmpeq_epi8(t, va), _mm256_cmpeq_epi8(t, vb));
+      count += __builtin_popcount((unsigned)_mm256_movemask_epi8(m));
+    }
+
+    return count + _kernel_count_tag_scalar(tags + i, n - i, a, b);
+}
+
+PRIVATE AVX2
+size_t _kernel_find_int_avx2(const uint8_t* tags, const Payload* data, size_t n, int x)
+{
+    const __m256i vx = _mm256_set1_epi32(x);
+    size_t i = 0;
+
+    for (; i + 8 <= n; i += 8) {
+      __m256i m = _mm256_and_si256(_avx2_tag_mask(&tags[i], T_INTEGER),
+                                   _mm256_cmpeq_epi32(_avx2_load_ints(&data[i]), vx));
+      int found = _mm256_movemask_ps(_mm256_castsi256_ps(m));
+      if (found) {
+          return i + __builtin_ctz(found); }
+    }
+
+    return i + _kernel_find_int_scalar(tags + i, data + i, n - i, x);
+}
+#endif
+
+PRIVATE
+size_t _kernel_sum_float(const uint8_t* tags, const Payload* data, size_t n, double* sum)
+{
+#ifdef SIMD_X86
+    if (HAVE_AVX2()) {
+        return _kernel_sum_float_avx2(tags, data, n, sum); }
+#endif
+#ifdef __SSE2__
+    return _kernel_sum_float_sse2(tags, data, n, sum);
+#else
+    return _kernel_sum_float_scalar(tags, data, n, sum);
+#endif
+}
+
+PRIVATE
+size_t _kernel_minmax_int(const uint8_t* tags, const Payload* data, size_t n, int* min, int* max)
+{
+#ifdef SIMD_X86
+    if (HAVE_AVX2()) {
+        return _kernel_minmax_int_avx2(tags, data, n, min, max); }
+#endif
+    return _kernel_minmax_int_scalar(tags, data, n, min, max);
+}
+
+PRIVATE
+size_t _kernel_count_tag(const uint8_t* tags, size_t n, uint8_t a, uint8_t b)
+{
+#ifdef SIMD_X86
+    if (HAVE_AVX2()) {
+        return _kernel_count_tag_avx2(tags, n, a, b); }
+#endif
+#ifdef __SSE2__
+    return _kernel_count_tag_sse2(tags, n, a, b);
+#else
+    return _kernel_count_tag_scalar(tags, n, a, b);
+#endif
+}
+
+PRIVATE
+size_t _kernel_find_int(const uint8_t* tags, const Payload* data, size_t n, int x)
+{
+#ifdef SIMD_X86
+    if (HAVE_AVX2()) {
+        return _kernel_find_int_avx2(tags, data, n, x); }
+#endif
+    return _kernel_find_int_scalar(tags, data, n, x);
+}
+
+ // aggregate contexts: "e" keeps the first conversion code met, like "list_get"
+
+typedef struct { double sum; errno_t e; } SumFloat;
+typedef struct { int min, max; size_t seen; errno_t e; } MinMaxInt;
+typedef struct { uint8_t a, b; size_t count; } CountTag;
+typedef struct { int x; size_t idx; bool found; } FindInt;
+
+PRIVATE
+bool _column_sum_float(List* list, const uint8_t* tags, const Payload* data, size_t n, size_t base, void* ctx)
+{
+    SumFloat* c = (SumFloat*) ctx;
+    double sum;
+
+    size_t others = _kernel_sum_float(tags, data, n, &sum);
+    c->sum += sum;
+    // convert mismatching values one by one
+    for (size_t i = 0; others > 0 && i < n; i++) {
+      if (tags[i] == T_FLOAT) {
+        continue; }
+      Value v; double f;
+      _payload_decode(list, tags[i], &data[i], &v);
+      errno_t e = _value_get_float(&v, &f);
+      if (e != EUNDEF) { c->sum += f; }
+      if (!c->e)       { c->e = e; }
+      others--;
+    }
+
+    return true;
+}
+
+PRIVATE
+bool _column_minmax_int(List* list, const uint8_t* tags, const Payload* data, size_t n, size_t base, void* ctx)
+{
+    MinMaxInt* c = (MinMaxInt*) ctx;
+
+    size_t others = _kernel_minmax_int(tags, data, n, &c->min, &c->max);
+    c->seen += n - others;
+    // convert mismatching values one by one
+    for (size_t i = 0; others > 0 && i < n; i++) {
+      if (tags[i] == T_INTEGER) {
+        continue; }
+      Value v; int x;
+      _payload_decode(list, tags[i], &data[i], &v);
+      errno_t e = _value_get_int(&v, &x);
+      if (e != EUNDEF) {
+        if (x < c->min) { c->min = x; }
+        if (x > c->max) { c->max = x; }
+        c->seen++;
+      }
+      if (!c->e) { c->e = e; }
+      others--;
+    }
+
+    return true;
+}
+
+PRIVATE
+bool _column_count_tag(List* list, const uint8_t* tags, const Payload* data, size_t n, size_t base, void* ctx)
+{
+    CountTag* c = (CountTag*) ctx;
+    c->count += _kernel_count_tag(tags, n, c->a, c->b);
+
+    return true;
+}
+
+PRIVATE
+bool _column_find_int(List* list, const uint8_t* tags, const Payload* data, size_t n, size_t base, void* ctx)
+{
+    FindInt* c = (FindInt*) ctx;
+
+    size_t i = _kernel_find_int(tags, data, n, c->x);
+    if (i < n) {
+      c->idx = base + i;
+      c->found = true;
+    }
+
+    return !c->found;
+}
+
+// FILE ("list_save()" format, all little-endian, mapped as it is by "list_map()")
+//
+//  0: "VLST", u16 version, u16 header size, u32 0
+//  8: u64 count, u64 tags offset, u64 payloads offset,
+// 32: u64 heap offset, u64 heap size, u64 journal generation, 8 bytes 0
+// 64: u8 tags[count], 0-padded to 8
+//     8-byte payloads[count]: ints and bools widened to 64 bits, floats as
+//     IEEE doubles, strings as heap offsets (~0 for nullptr) or inline (T_SSTR),
+//     blobs as heap offsets or inline (T_SBLOB, size in the last byte)
+//     heap: NUL-terminated strings, blobs as u32 size then bytes then a 0
+//     (version 2: int64s and blobs; version 1 files still map)
+
+#define FILE_MAGIC   "VLST"
+#define FILE_VERSION 2
+#define FILE_HEADER  64
+
+PRIVATE
+bool _host_little_endian(void)
+{
+    const uint16_t one = 1;
+    return *(const uint8_t*)&one == 1;
+}
+
+PRIVATE
+void _put_le(uint8_t* p, uint64_t x, size_t bytes)
+{
+    for (size_t b = 0; b < bytes; b++) {
+      p[b] = (uint8_t)(x >> (8 * b)); }
+}
+
+PRIVATE
+uint64_t _get_le(const uint8_t* p, size_t bytes)
+{
+    uint64_t x = 0;
+    for (size_t b = 0; b < bytes; b++) {
+      x |= (uint64_t)p[b] << (8 * b); }
+    return x;
+}
+
+ // file tag and payload of "v", advancing "heap" past long strings (and blobs)
+PRIVATE
+uint8_t _file_encode(const Value* v, uint8_t* out, uint64_t* heap)
+{
+    memset(out, 0, 8);
+
+    switch (v->t) {
+      case T_INTEGER: _put_le(out, (uint64_t)(int64_t)v->i, 8); break;
+      case T_BOOLEAN: out[0] = v->b;                            break;
+      case T_FLOAT  : { uint64_t u;
+                        memcpy(&u, &v->f, sizeof(u));
+                        _put_le(out, u, 8); }                   break;
+      case T_STRING : if (!v->s) {
+                        _put_le(out, UINT64_MAX, 8); break; }
+                      { size_t len = strlen(v->s);
+                        if (len < 8) {
+                          memcpy(out, v->s, len);
+                          return T_SSTR; }
+                        _put_le(out, *heap, 8);
+                        *heap += len + 1; }                     break;
+      case T_INT64  : _put_le(out, (uint64_t)v->l, 8);          break;
+      case T_BLOB   : if (v->n <= BLOB_INLINE) {
+                        memcpy(out, _value_bytes(v), v->n);
+                        out[BLOB_INLINE] = (uint8_t)v->n;
+                        return T_SBLOB; }
+                      _put_le(out, *heap, 8);
+                      *heap += BLOB_HEADER + v->n + 1;          break;
+      default       : break;
+    }
+
+    return (uint8_t)v->t;
+}
+
+PRIVATE
+void _file_header(uint8_t* h, size_t n, uint64_t heap, uint64_t generation)
+{
+    uint64_t tags_off = FILE_HEADER;
+    uint64_t data_off = (tags_off + n + 7) & ~(uint64_t)7;
+
+    memset(h, 0, FILE_HEADER);
+    memcpy(h, FILE_MAGIC, 4);
+    _put_le(h + 4, FILE_VERSION, 2);
+    _put_le(h + 6, FILE_HEADER, 2);
+    _put_le(h + 8, n, 8);
+    _put_le(h + 16, tags_off, 8);
+    _put_le(h + 24, data_off, 8);
+    _put_le(h + 32, data_off + 8 * n, 8);
+    _put_le(h + 40, heap, 8);
+    _put_le(h + 48, generation, 8);
+}
+
+ // one pass per section: tags, payloads, heap
+PRIVATE
+bool _file_write(List* list, FILE* f, uint64_t generation)
+{
+    size_t n = list->length;
+    uint64_t tags_off = FILE_HEADER;
+    uint64_t data_off = (tags_off + n + 7) & ~(uint64_t)7;
+    uint64_t heap = 0;
+    uint8_t out[8];
+    Cursor at;
+
+    if (fseek(f, (long)tags_off, SEEK_SET) != 0) {
+        return false; }
+    for (size_t i = 0; i < n; i++) {
+      Value* v = i ? _list_step(list, &at) : _list_seek(list, &at, 0);
+      uint8_t tag = _file_encode(v, out, &heap);
+      if (fputc(tag, f) == EOF) {
+          return false; }
+    }
+
+    memset(out, 0, sizeof(out));
+    if (fwrite(out, 1, data_off - tags_off - n, f) != data_off - tags_off - n) {
+        return false; }
+    heap = 0;
+    for (size_t i = 0; i < n; i++) {
+      Value* v = i ? _list_step(list, &at) : _list_seek(list, &at, 0);
+      _file_encode(v, out, &heap);
+      if (fwrite(out, 1, 8, f) != 8) {
+          return false; }
+    }
+
+    for (size_t i = 0; i < n; i++) {
+      Value* v = i ? _list_step(list, &at) : _list_seek(list, &at, 0);
+      if (v->t == T_STRING && v->s && strlen(v->s) >= 8 &&
+          fwrite(v->s, 1, strlen(v->s) + 1, f) != strlen(v->s) + 1) {
+          return false; }
+      if (_value_long_blob(v)) {
+        uint8_t size[BLOB_HEADER];
+        _put_le(size, v->n, BLOB_HEADER);
+        if (fwrite(size, 1, BLOB_HEADER, f) != BLOB_HEADER ||
+            fwrite(v->p, 1, v->n, f) != v->n || fputc(0, f) == EOF) {
+            return false; }
+      }
+    }
+
+    uint8_t h[FILE_HEADER];
+    _file_header(h, n, heap, generation);
+
+    return (fseek(f, 0, SEEK_SET) == 0) && (fwrite(h, 1, FILE_HEADER, f) == FILE_HEADER);
+}
+
+ // the whole file, read-only, paged in on access
+PRIVATE
+void* _file_map(const char* path, size_t* size)
+{
+#ifdef _WIN32
+    HANDLE f = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr,
+                           OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (f == INVALID_HANDLE_VALUE) {
+        errno = ENOENT; return nullptr; }
+    LARGE_INTEGER li;
+    HANDLE m = nullptr;
+    if (GetFileSizeEx(f, &li) && li.QuadPart > 0) {
+      m = CreateFileMappingA(f, nullptr, PAGE_READONLY, 0, 0, nullptr); }
+    CloseHandle(f);
+    if (!m) {
+        errno = EINVAL; return nullptr; }
+    void* p = MapViewOfFile(m, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(m);       // the view keeps it alive
+    if (!p) {
+        errno = ENOMEM; return nullptr; }
+    *size = (size_t)li.QuadPart;
+    return p;
+#else
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return nullptr; }
+    struct stat st;
+    void* p = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+      p = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0); }
+    else {
+      errno = EINVAL; }
+    close(fd);            // the mapping keeps it alive
+    if (p == MAP_FAILED) {
+        return nullptr; }
+    *size = (size_t)st.st_size;
+    return p;
+#endif
+}
+
+PRIVATE
+void _file_unmap(void* p, size_t size)
+{
+#ifdef _WIN32
+    (void)size;
+    UnmapViewOfFile(p);
+#else
+    munmap(p, size);
+#endif
+}
+
+
+// WRITE ("list_write()": values formatted into one buffer, big "write()"s)
+
+#define WRITE_BUFFER (1 << 20)
+
+#ifdef _WIN32
+#  define _fd_write(FD, P, N) _write(FD, P, (unsigned int)(N))
+#  define _stdout_fd()        _fileno(stdout)
+#else
+#  define _fd_write(FD, P, N) write(FD, P, N)
+#  define _stdout_fd()        fileno(stdout)
+#endif
+
+typedef struct
+{
+    int fd;
+    char* buf;
+    size_t used;
+    errno_t e;            // first failure: what follows gets dropped
+} Writer;
+
+PRIVATE
+errno_t _write_all(int fd, const char* p, size_t n)
+{
+    while (n > 0) {
+      ptrdiff_t k = _fd_write(fd, p, (n > INT_MAX) ? INT_MAX : n);
+      if (k < 0 && errno == EINTR) {
+          continue; }
+      if (k <= 0) {
+          return (k < 0) ? errno : EIO; }
+      p += k;
+      n -= (size_t)k;
+    }
+    return EXIT_SUCCESS;
+}
+
+PRIVATE
+void _writer_flush(Writer* w)
+{
+    if (!w->e) {
+      w->e = _write_all(w->fd, w->buf, w->used); }
+    w->used = 0;
+}
+
+ // room for "n" (up to WRITE_BUFFER) more bytes, then "w->used += " them
+PRIVATE
+char* _writer_room(Writer* w, size_t n)
+{
+    if (w->used + n > WRITE_BUFFER) {
+      _writer_flush(w); }
+    return w->buf + w->used;
+}
+
+PRIVATE
+void _writer_put(Writer* w, const void* p, size_t n)
+{
+    if (n > WRITE_BUFFER)
+    { _writer_flush(w);
+      if (!w->e) {
+        w->e = _write_all(w->fd, (const char*)p, n); }
+      return; }
+
+    memcpy(_writer_room(w, n), p, n);
+    w->used += n;
+}
+
+#define _writer_puts(W, S) _writer_put(W, S, strlen(S))
+
+PRIVATE
+void _write_hex(Writer* w, const uint8_t* p, size_t n)
+{
+    static const char hex[] = "0123456789abcdef";
+
+    for (size_t i = 0; i < n; ) {
+      size_t k = (n - i > WRITE_BUFFER / 2) ? WRITE_BUFFER / 2 : n - i;
+      char* out = _writer_room(w, 2 * k);
+      for (size_t j = 0; j < k; j++, i++) {
+        out[2 * j]     = hex[p[i] >> 4];
+        out[2 * j + 1] = hex[p[i] & 15];
+      }
+      w->used += 2 * k;
+    }
+}
+
+PRIVATE
+void _write_base64(Writer* w, const uint8_t* p, size_t n)
+{
+    static const char b64[] =
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+    for (size_t i = 0; i < n; ) {
+      size_t k = (n - i > WRITE_BUFFER / 4 * 3) ? WRITE_BUFFER / 4 * 3 : n - i;
+      char* out = _writer_room(w, (k + 2) / 3 * 4);
+      size_t o = 0;
+      for (size_t end = i + k; i < end; i += 3) {
+        uint32_t x = (uint32_t)p[i] << 16;
+        x |= (i + 1 < end) ? (uint32_t)p[i + 1] << 8 : 0;
+        x |= (i + 2 < end) ? (uint32_t)p[i + 2] : 0;
+        out[o++] = b64[x >> 18];
+        out[o++] = b64[(x >> 12) & 63];
+        out[o++] = (i + 1 < end) ? b64[(x >> 6) & 63] : '=';
+        out[o++] = (i + 2 < end) ? b64[x & 63] : '=';
+      }
+      w->used += o;
+    }
+}
+
+ // quoted, with '"', '\\' and control characters escaped (UTF-8 as it is)
+PRIVATE
+void _write_json_string(Writer* w, const char* s)
+{
+    static const char hex[] = "0123456789abcdef";
+    const char* from = s;
+
+    _writer_put(w, "\"", 1);
+    for (; *s; s++) {
+      unsigned char c = (unsigned char)*s;
+      if (c >= 0x20 && c != '"' && c != '\\') {
+          continue; }
+      _writer_put(w, from, s - from);
+      char esc[6] = { '\\', (char)c, '0', '0', hex[c >> 4], hex[c & 15] };
+      switch (c) {
+        case '"' : case '\\': break;
+        case '\n': esc[1] = 'n'; break;
+        case '\r': esc[1] = 'r'; break;
+        case '\t': esc[1] = 't'; break;
+        default  : esc[1] = 'u'; _writer_put(w, esc, 6); from = s + 1; continue;
+      }
+      _writer_put(w, esc, 2);
+      from = s + 1;
+    }
+    _writer_put(w, from, s - from);
+    _writer_put(w, "\"", 1);
+}
+
+ // RFC 4180: quoted (quotes doubled) only if it must be; "" is an empty one
+PRIVATE
+void _write_csv_string(Writer* w, const char* s)
+{
+    size_t len = strlen(s);
+    if (len > 0 && !strpbrk(s, ",\"\r\n") && s[0] != ' ' && s[len - 1] != ' ') {
+      _writer_put(w, s, len);
+      return; }
+
+    _writer_put(w, "\"", 1);
+    for (const char* q; (q = strchr(s, '"')) != nullptr; s = q + 1) {
+      _writer_put(w, s, q + 1 - s);
+      _writer_put(w, "\"", 1);
+    }
+    _writer_puts(w, s);
+    _writer_put(w, "\"", 1);
+}
+
+static const char* const _type_names[] = {
+    "UNDEFINED", "INTEGER", "BOOLEAN", "FLOAT", "STRING", "INT64", "BLOB" };
+
+ // "list_dump()" lines: "[i]: (TYPE)\tvalue"
+PRIVATE
+void _write_text(Writer* w, Value* v, size_t i)
+{
+    char* out = _writer_room(w, VALUE_TEXT_MAX);
+    out[0] = '[';
+    w->used += 1 + _format_uint(out + 1, i);
+    _writer_puts(w, "]: (");
+    _writer_puts(w, (v->t <= T_BLOB) ? _type_names[v->t] : "ERR: Undefined");
+    _writer_put(w, ")\t", 2);
+
+    switch (v->t) {
+      case T_FLOAT  : out = _writer_room(w, FLOAT_FIXED_MAX);
+                      w->used += _snprintf_c(out, FLOAT_FIXED_MAX, "%.6f", v->f); break;
+      case T_STRING : _writer_puts(w, v->s ? v->s : "(null)");   break;
+      case T_BLOB   : _write_hex(w, _value_bytes(v), v->n);        break;
+      default       : out = _writer_room(w, VALUE_TEXT_MAX);
+                      w->used += _value_render(v, out);            break;
+    }
+    _writer_put(w, "\n", 1);
+}
+
+ // numbers in round-trip form (see "_format_float()"), NaN/infinities as null
+PRIVATE
+void _write_json(Writer* w, Value* v, size_t i)
+{
+    if (i > 0) {
+      _writer_put(w, ",", 1); }
+
+    switch (v->t) {
+      case T_STRING : if (v->s) { _write_json_string(w, v->s); }
+                      else      { _writer_puts(w, "null"); }
+                      break;
+      case T_BLOB   : _writer_puts(w, "{\"blob\":\"");
+                      _write_base64(w, _value_bytes(v), v->n);
+                      _writer_puts(w, "\"}");
+                      break;
+      case T_FLOAT  : if (!isfinite(v->f)) {
+                        _writer_puts(w, "null"); break; }
+                      // fall through
+      default       : { char* out = _writer_room(w, VALUE_TEXT_MAX);
+                        w->used += _value_render(v, out); }
+                      break;
+    }
+}
+
+ // "type,value" lines after a header one; nullptr strings are empty fields
+PRIVATE
+void _write_csv(Writer* w, Value* v, size_t i)
+{
+    if (i == 0) {
+      _writer_puts(w, "type,value\n"); }
+    _writer_puts(w, (v->t <= T_BLOB) ? _type_names[v->t] : _type_names[T_UNDEF]);
+    _writer_put(w, ",", 1);
+
+    switch (v->t) {
+      case T_STRING : if (v->s) { _write_csv_string(w, v->s); }  break;
+      case T_BLOB   : _write_hex(w, _value_bytes(v), v->n);      break;
+      default       : { char* out = _writer_room(w, VALUE_TEXT_MAX);
+                        w->used += _value_render(v, out); }      break;
+    }
+    _writer_put(w, "\n", 1);
+}
+
+ // "list_save()" format in order, no seeking: a first pass sizes the heap
+PRIVATE
+void _write_binary(Writer* w, List* list)
+{
+    size_t n = list->length;
+    uint64_t heap = 0;
+    uint8_t out[FILE_HEADER];
+    Cursor at;
+
+    for (size_t i = 0; i < n; i++) {
+      Value* v = i ? _list_step(list, &at) : _list_seek(list, &at, 0);
+      _file_encode(v, out, &heap);
+    }
+    _file_header(out, n, heap, 0);
+    _writer_put(w, out, FILE_HEADER);
+
+    heap = 0;
+    for (size_t i = 0; i < n; i++) {
+      Value* v = i ? _list_step(list, &at) : _list_seek(list, &at, 0);
+      *(uint8_t*)_writer_room(w, 1) = _file_encode(v, out, &heap);
+      w->used++;
+    }
+    memset(out, 0, 8);
+    _writer_put(w, out, ((n + 7) & ~(size_t)7) - n);
+
+    heap = 0;
+    for (size_t i = 0; i < n; i++) {
+      Value* v = i ? _list_step(list, &at) : _list_seek(list, &at, 0);
+      _file_encode(v, out, &heap);
+      _writer_put(w, out, 8);
+    }
+
+    for (size_t i = 0; i < n; i++) {
+      Value* v = i ? _list_step(list, &at) : _list_seek(list, &at, 0);
+      if (v->t == T_STRING && v->s && strlen(v->s) >= 8) {
+        _writer_put(w, v->s, strlen(v->s) + 1); }
+      if (_value_long_blob(v)) {
+        _put_le(out, v->n, BLOB_HEADER);
+        _writer_put(w, out, BLOB_HEADER);
+        _writer_put(w, v->p, v->n);
+        _writer_put(w, "", 1);
+      }
+    }
+}
+
+ // all of "list" (locked) to "w"
+PRIVATE
+void _write_list(Writer* w, List* list, unsigned int format)
+{
+    size_t n = list->length;
+    Cursor at;
+
+    switch (format) {
+      case LIST_BINARY: _write_binary(w, list); return;
+      case LIST_TEXT  : { char* out = _writer_room(w, 64);
+                          w->used += snprintf(out, 64, "List length: %zd\n-----------\n%s",
+                                              n, (n == 0) ? "<empty>\n" : ""); }
+                        break;
+      case LIST_JSON  : _writer_put(w, "[", 1); break;
+      case LIST_CSV   : if (n == 0) { _writer_puts(w, "type,value\n"); } break;
+    }
+
+    for (typeof(n) i = 0; i < n && !w->e; i++) { // C23
+      Value* v = i ? _list_step(list, &at) : _list_seek(list, &at, 0);
+      switch (format) {
+        case LIST_TEXT: _write_text(w, v, i); break;
+        case LIST_JSON: _write_json(w, v, i); break;
+        case LIST_CSV : _write_csv(w, v, i);  break;
+      }
+    }
+
+    switch (format) {
+      case LIST_TEXT: _writer_put(w, "\n", 1);  break;
+      case LIST_JSON: _writer_put(w, "]\n", 2); break;
+    }
+}
+
+
+// SHARED ("list_create_shared()" memory, a "list_map()" file made writable)
+//
+//  0: SharedHeader, 0-padded to 64
+//     u8 tags[capacity], 0-padded to 4
+//     u32 state[capacity]: 0 free, then the pid of the process writing it,
+//     then SHARED_READY; 0-padded to 8
+//     8-byte payloads[capacity]: as in a file (strings as heap offsets)
+//     heap: NUL-terminated strings and blob records, SHARED_HEAP_PER_VALUE
+//     bytes per value
+
+#define SHARED_MAGIC          0x4D534C56   // "VLSM"
+#define SHARED_VERSION        3
+#define SHARED_READY          UINT32_MAX   // no pid
+#define SHARED_HEAP_PER_VALUE 32
+#define SHARED_WAIT_US        100000       // for a creator to be done, and our lock
+
+ // offsets of the tags, payloads and heap; returns the whole size
+PRIVATE
+size_t _shared_layout(size_t capacity, size_t* tags, size_t* data, size_t* heap)
+{
+    *tags = (sizeof(SharedHeader) + 63) & ~(size_t)63;
+    size_t state = (*tags + capacity + 3) & ~(size_t)3;
+    *data = (state + 4 * capacity + 7) & ~(size_t)7;
+    *heap = *data + capacity * sizeof(Payload);
+
+    return *heap + capacity * SHARED_HEAP_PER_VALUE;
+}
+
+PRIVATE
+atomic_uint* _shared_state(List* list)
+{
+    return (atomic_uint*)(((uintptr_t)(list->tags + list->capacity) + 3) & ~(uintptr_t)3);
+}
+
+PRIVATE
+unsigned int _process_id(void)
+{
+#ifdef _WIN32
+    return (unsigned int)GetCurrentProcessId();
+#else
+    return (unsigned int)getpid();
+#endif
+}
+
+ // false once it is gone (an unreaped zombie still counts)
+PRIVATE
+bool _process_alive(unsigned int pid)
+{
+#ifdef _WIN32
+    HANDLE p = OpenProcess(SYNCHRONIZE, FALSE, (DWORD)pid);
+    if (!p) {
+        return GetLastError() != ERROR_INVALID_PARAMETER; }
+    bool alive = (WaitForSingleObject(p, 0) == WAIT_TIMEOUT);
+    CloseHandle(p);
+    return alive;
+#else
+    int e = errno;
+    bool alive = (kill((pid_t)pid, 0) == 0 || errno != ESRCH);
+    errno = e;
+    return alive;
+#endif
+}
+
+PRIVATE
+void _shared_sleep(void)
+{
+    thrd_sleep(&(struct timespec){ .tv_nsec = 1000000 }, nullptr);
+}
+
+ // creates "size" bytes under "name" (0: opens them), "*created" telling if
+ // we did, "*size" getting what got mapped
+PRIVATE
+void* _shared_map(const char* name, size_t* size, bool* created)
+{
+#ifdef _WIN32
+    HANDLE m = *size ? CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+                                          (DWORD)((uint64_t)*size >> 32), (DWORD)*size, name)
+                     : OpenFileMappingA(FILE_MAP_ALL_ACCESS, FALSE, name);
+    if (!m) {
+        errno = *size ? ENOMEM : ENOENT; return nullptr; }
+    *created = *size && (GetLastError() != ERROR_ALREADY_EXISTS);
+    void* p = MapViewOfFile(m, FILE_MAP_ALL_ACCESS, 0, 0, 0);
+    CloseHandle(m);       // the view keeps it alive (and it goes with the last one)
+    MEMORY_BASIC_INFORMATION mbi;
+    if (!p || !VirtualQuery(p, &mbi, sizeof(mbi))) {
+        errno = ENOMEM; return nullptr; }
+    *size = mbi.RegionSize;
+    return p;
+#else
+    int fd = *size ? shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600) : -1;
+    *created = (fd >= 0);
+    if (fd < 0 && (!*size || errno == EEXIST)) {
+      fd = shm_open(name, O_RDWR, 0); }
+    if (fd < 0) {
+        return nullptr; }
+
+    struct stat st = { .st_size = 0 };
+    if (*created && ftruncate(fd, (off_t)*size) != 0)
+    {   close(fd);
+        shm_unlink(name);
+        errno = ENOMEM; return nullptr; }
+    // else wait for its creator to size it
+    for (size_t us = 0; !*created && us < SHARED_WAIT_US; us += 1000) {
+      if (fstat(fd, &st) != 0 || st.st_size > 0) {
+        break; }
+      _shared_sleep();
+    }
+    if (!*created) {
+      *size = (size_t)st.st_size; }
+
+    void* p = *size ? mmap(nullptr, *size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)
+                    : MAP_FAILED;
+    close(fd);            // the mapping keeps it alive
+    if (p == MAP_FAILED)
+    {   if (*created) {
+          shm_unlink(name); }
+        errno = *size ? ENOMEM : EAGAIN; return nullptr; }
+    return p;
+#endif
+}
+
+ // the last list out of the memory removes its name
+PRIVATE
+void _shared_detach(List* list)
+{
+    if (atomic_fetch_sub(&list->shared->attached, 1) == 1) {
+#ifndef _WIN32
+      shm_unlink(list->shared_name);
+#endif
+    }
+    free(list->shared_name);
+}
+
+ // moves "length" over all ready slots: whoever readies the slot where it
+ // stops carries it on (seq_cst: one of us always sees the other's slot)
+PRIVATE
+void _shared_publish(List* list)
+{
+    SharedHeader* h = list->shared;
+    atomic_uint* state = _shared_state(list);
+
+    size_t n = atomic_load(&h->length);
+    while (n < list->capacity && atomic_load(&state[n]) == SHARED_READY) {
+      if (atomic_compare_exchange_weak(&h->length, &n, n + 1)) {
+        n++; }
+    }
+}
+
+ // for readers: a process that died between taking a slot and readying it
+ // would hold "length" back for good, so its slot gets readied as no value
+ // (T_UNDEF) instead; another reclaiming one takes it over first the same way
+PRIVATE
+void _shared_reclaim(List* list)
+{
+    SharedHeader* h = list->shared;
+    atomic_uint* state = _shared_state(list);
+
+    for (;;) {
+      size_t n = atomic_load(&h->length);
+      if (n >= list->capacity) {
+          return; }
+      unsigned int pid = atomic_load(&state[n]);
+      if (pid == 0 || pid == SHARED_READY || _process_alive(pid) ||
+          !atomic_compare_exchange_strong(&state[n], &pid, _process_id())) {
+          return; }
+      list->tags[n] = T_UNDEF;
+      memset(&list->data[n], 0, sizeof(Payload));
+      atomic_store(&state[n], SHARED_READY);
+      _shared_publish(list);
+    }
+}
+
+ // lock-free: takes a slot (and heap room), writes it, then publishes it
+PRIVATE
+errno_t _shared_add(List* list, const Value* v)
+{
+    SharedHeader* h = list->shared;
+    bool blob = _value_long_blob(v);
+    bool heap = blob ||
+                ((v->t == T_STRING) && (!v->s || strlen(v->s) >= sizeof(Payload)));
+
+    uint64_t off = UINT64_MAX;            // nullptr
+    if (blob || (heap && v->s))
+    { size_t n = blob ? BLOB_HEADER + v->n : strlen(v->s) + 1;
+      off = atomic_fetch_add(&h->heap_used, n);
+      if (off + n > list->heap_size) {
+          return errno = ENOMEM; }
+      char* rec = (char*)list->heap + off;
+      if (blob)
+      {   memcpy(rec, &v->n, BLOB_HEADER);
+          memcpy(rec + BLOB_HEADER, v->p, v->n); }
+      else {
+        memcpy(rec, v->s, n); }
+    }
+
+    // taking a slot marks it with our pid in one step, so that there is
+    // no window where we could die holding one nobody can tell is ours
+    atomic_uint* state = _shared_state(list);
+    unsigned int pid = _process_id();
+    size_t slot = atomic_load(&h->reserved);
+    for (;; slot++) {
+      if (slot >= list->capacity) {
+          return errno = ENOMEM; }
+      unsigned int free_slot = 0;
+      if (atomic_compare_exchange_strong(&state[slot], &free_slot, pid)) {
+          break; }
+    }
+    size_t r = atomic_load(&h->reserved);
+    while (r <= slot && !atomic_compare_exchange_weak(&h->reserved, &r, slot + 1)) {}
+    if (heap)
+    {   list->tags[slot] = (uint8_t)v->t;
+        memcpy(&list->data[slot], &off, sizeof(off)); }
+    else {
+      _store_put(list, slot, v); }
+
+    atomic_store(&state[slot], SHARED_READY);
+    _shared_publish(list);
+
+    return EXIT_SUCCESS;
+}
+
+// JOURNAL (append-only change records, folded into a "list_save()" snapshot)
+//
+//  0: "VLJR", u16 version, u16 0, u64 generation (of the snapshot it follows)
+// 16: records: u8 op, varint index, [u8 tag, value], u32 FNV-1a of the record
+//     values: ints and int64s zigzag varints, bools 1 byte, floats 8 bytes,
+//     strings varint length+1 (0 for nullptr) then bytes, blobs varint size
+//     then bytes (version 2: int64s and blobs; version 1 journals replay)
+
+#define JOURNAL_MAGIC   "VLJR"
+#define JOURNAL_VERSION 2
+#define JOURNAL_HEADER  16
+#define JOURNAL_CHECKPOINT_MIN 65536  // records, before replay gets costly
+
+enum { J_INSERT = 1, J_DELETE, J_CLEAR };
+
+PRIVATE
+size_t _varint_put(uint8_t* p, uint64_t x)
+{
+    size_t n = 0;
+    for (; x >= 0x80; x >>= 7) {
+      p[n++] = (uint8_t)(x | 0x80); }
+    p[n++] = (uint8_t)x;
+
+    return n;
+}
+
+PRIVATE
+bool _varint_get(const uint8_t* p, size_t size, size_t* pos, uint64_t* x)
+{
+    *x = 0;
+    for (int shift = 0; *pos < size && shift < 64; shift += 7) {
+      uint8_t b = p[(*pos)++];
+      *x |= (uint64_t)(b & 0x7f) << shift;
+      if (!(b & 0x80)) {
+          return true; }
+    }
+
+    return false;
+}
+
+#define FNV32_INIT 2166136261u
+
+PRIVATE
+uint32_t _fnv32(uint32_t h, const void* p, size_t n)
+{
+    for (size_t i = 0; i < n; i++) {
+      h = (h ^ ((const uint8_t*)p)[i]) * 16777619u; }
+
+    return h;
+}
+
+PRIVATE
+bool _file_sync(FILE* f)
+{
+    if (fflush(f) != 0) {
+        return false; }
+#ifdef _WIN32
+    return _commit(_fileno(f)) == 0;
+#else
+    return fsync(fileno(f)) == 0;
+#endif
+}
+
+ // atomic "rename()", made durable
+PRIVATE
+bool _file_replace(const char* from, const char* to)
+{
+#ifdef _WIN32
+    return MoveFileExA(from, to, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH);
+#else
+    if (rename(from, to) != 0) {
+        return false; }
+    // the directory entry too
+    char* dir = strdup(to);
+    char* slash = dir ? strrchr(dir, '/') : nullptr;
+    if (slash) { *(slash == dir ? slash + 1 : slash) = '\0'; }
+    int fd = open(slash ? dir : ".", O_RDONLY);
+    free(dir);
+    bool ok = (fd >= 0) && (fsync(fd) == 0);
+    if (fd >= 0) {
+      close(fd); }
+    return ok;
+#endif
+}
+
+PRIVATE
+void _journal_fail(Journal* j)
+{
+    if (j->f) {
+      fclose(j->f); }
+    j->f = nullptr;
+}
+
+ // written before the change it describes, which is not made if it fails:
+ // the journal is then closed, and later changes get EIO up front too
+ // (until "list_checkpoint()" starts a fresh one)
+PRIVATE
+bool _journal_record(List* list, uint8_t op, size_t idx, const Value* v)
+{
+    Journal* j = list->journal;
+    if (!j->f) {
+        return false; }
+
+    uint8_t rec[32];
+    size_t n = 0;
+    const char* s = nullptr;
+    size_t len = 0;
+
+    rec[n++] = op;
+    n += _varint_put(rec + n, idx);
+    if (v) {
+      rec[n++] = (uint8_t)v->t;
+      switch (v->t) {
+        case T_INTEGER: { int64_t i = v->i;
+                          n += _varint_put(rec + n, ((uint64_t)i << 1) ^ (uint64_t)(i >> 63)); }
+                        break;
+        case T_BOOLEAN: rec[n++] = v->b;
+                        break;
+        case T_FLOAT  : { uint64_t u;
+                          memcpy(&u, &v->f, sizeof(u));
+                          _put_le(rec + n, u, 8);
+                          n += 8; }
+                        break;
+        case T_STRING : s = v->s;
+                        len = s ? strlen(s) : 0;
+                        n += _varint_put(rec + n, s ? len + 1 : 0);
+                        break;
+        case T_INT64  : n += _varint_put(rec + n, ((uint64_t)v->l << 1) ^ (uint64_t)(v->l >> 63));
+                        break;
+        case T_BLOB   : s = (const char*)_value_bytes(v);
+                        len = v->n;
+                        n += _varint_put(rec + n, len);
+                        break;
+        default       : break;
+      }
+    }
+
+    uint8_t sum[4];
+    _put_le(sum, _fnv32(_fnv32(FNV32_INIT, rec, n), s, len), 4);
+
+    // (pushed out now if this change gets fsync'ed, so that a full disk
+    // shows here rather than after the change)
+    bool due = j->sync_every && j->pending + 1 >= j->sync_every;
+    if (fwrite(rec, 1, n, j->f) != n ||
+        (len && fwrite(s, 1, len, j->f) != len) ||
+        fwrite(sum, 1, 4, j->f) != 4 ||
+        (due && fflush(j->f) != 0))
+    {   _journal_fail(j);
+        return false; }
+
+    j->records++;
+    return true;
+}
+
+PRIVATE
+bool _journal_insert(List* list, size_t pos, const Value* v)
+{
+    return !list->journal || _journal_record(list, J_INSERT, pos, v);
+}
+
+PRIVATE
+bool _journal_delete(List* list, size_t idx)
+{
+    return !list->journal || _journal_record(list, J_DELETE, idx, nullptr);
+}
+
+PRIVATE
+bool _journal_clear(List* list)
+{
+    return !list->journal || _journal_record(list, J_CLEAR, 0, nullptr);
+}
+
+ // for changes journaled by a checkpoint (sorts...): checked before them
+PRIVATE
+bool _journal_ok(List* list)
+{
+    return !list->journal || list->journal->f;
+}
+
+PRIVATE
+bool _journal_header(Journal* j)
+{
+    uint8_t h[JOURNAL_HEADER] = { 0 };
+    memcpy(h, JOURNAL_MAGIC, 4);
+    _put_le(h + 4, JOURNAL_VERSION, 2);
+    _put_le(h + 8, j->generation, 8);
+
+    return fwrite(h, 1, JOURNAL_HEADER, j->f) == JOURNAL_HEADER;
+}
+
+ // snapshot of the list (lock held) as next generation, then a fresh journal
+PRIVATE
+errno_t _journal_checkpoint(List* list)
+{
+    Journal* j = list->journal;
+    size_t len = strlen(j->path);
+    char* snap = (char*) malloc(len + 6);
+    char* tmp = (char*) malloc(len + 10);
+    if (!snap || !tmp)
+    {   free(snap); free(tmp);
+        return errno = ENOMEM; }
+    sprintf(snap, "%s.snap", j->path);
+    sprintf(tmp, "%s.snap.tmp", j->path);
+
+    FILE* f = fopen(tmp, "wb");
+    bool ok = f && _file_write(list, f, j->generation + 1) && _file_sync(f);
+    if (f && fclose(f) != 0) {
+      ok = false; }
+    ok = ok && _file_replace(tmp, snap);
+
+    // the old journal is stale now (older generation): start over
+    if (ok) {
+      if (j->f) {
+        fclose(j->f); }
+      j->f = fopen(j->path, "wb");
+      j->generation++;
+      j->records = j->pending = 0;
+      ok = j->f && _journal_header(j) && _file_sync(j->f);
+    } else {
+      remove(tmp);
+    }
+
+    free(snap);
+    free(tmp);
+
+    return ok ? EXIT_SUCCESS : (errno = EIO);
+}
+
+ // ends each change (lock held): notifies, fsync per "sync_every" of them
+PRIVATE
+errno_t _journal_commit(List* list)
+{
+    _list_notify(list);
+
+    Journal* j = list->journal;
+    if (!j) {
+        return EXIT_SUCCESS; }
+    if (!j->f) {
+        return errno = EIO; }
+
+    j->pending++;
+    if (j->sync_every && j->pending >= j->sync_every) {
+      if (!_file_sync(j->f))
+      {   _journal_fail(j);
+          return errno = EIO; }
+      j->pending = 0;
+    }
+    if (ferror(j->f))
+    {   _journal_fail(j);
+        return errno = EIO; }
+
+    // replay costs as much as the journal is long: fold it when it gets long
+    // (if that fails, the journal is still whole: keep appending to it)
+    if (j->records >= JOURNAL_CHECKPOINT_MIN && j->records > 2 * list->length) {
+      _journal_checkpoint(list); }
+
+    return EXIT_SUCCESS;
+}
+
+PRIVATE
+void _value_free_chain(List* list, Value* first)
+{
+    while (first != nullptr) {
+      Value* next = first->next;
+      _value_destroy(list, first);
+      first = next;
+    }
+}
+
+ // appends "n" chained values (lock held), consumed even on failure
+PRIVATE
+errno_t _list_link_chain(List* list, Value* first, Value* last, size_t n)
+{
+    if (list->flags & LIST_COMPACT)
+    { errno_t e = _store_reserve(list, n) ? EXIT_SUCCESS : (errno = ENOMEM);
+      size_t k = 0;
+      for (Value* c = first; !e && c != nullptr; c = c->next, k++) {
+        if (!_journal_insert(list, list->length, c))
+        {   e = errno = EIO;
+            break; }
+        _store_put(list, list->length, c);
+        _index_insert(list, list->length++, nullptr); }
+      if (k > 0) {
+        errno_t j = _journal_commit(list);
+        e = e ? e : j; }
+      _value_free_chain(list, first);
+      return e;
+    }
+
+    // re-index the chain up to a failed record, then link it after our last value
+    errno_t e = EXIT_SUCCESS;
+    size_t pos = list->length, k = 0;
+    Value* prev = list->last;
+    for (Value* c = first; c != nullptr; prev = c, c = c->next, k++) {
+      if (!_journal_insert(list, pos + k, c))
+      {   e = errno = EIO;
+          break; }
+      c->idx = pos + k + list->origin;
+      c->prev = prev;
+      _index_insert(list, pos + k, c); }
+    if (k < n)
+    { Value* rest = (k > 0) ? prev->next : first;
+      if (k > 0) {
+        prev->next = nullptr;
+        last = prev; }
+      _value_free_chain(list, rest);
+      if (k == 0) {
+          return e; }
+    }
+    if (first != nullptr)
+    { switch (list->last == nullptr) {
+        case true:  list->first = first; break;
+        case false: list->last->next = first;
+      }
+      list->last = last;
+    }
+
+    list->length += k;
+    errno_t j = _journal_commit(list);
+    return e ? e : j;
+}
+
+
+// SHARDS (LIST_SHARDED appends: per-thread FIFO, global order by merge)
+
+#define SHARDS_PER_CPU 4
+#define SHARDS_MAX     64
+#define SHARD_BATCH    256  // values held before a shard merges itself...
+#define SHARD_DELAY_MS 5    // ...or age of its oldest one (checked every 32)
+
+ // threads take a ticket on their first sharded append, and keep it: up to
+ // "count" of them never share a shard (no TLS destructor to run either)
+static atomic_size_t _shard_tickets;
+static thread_local size_t _shard_ticket;    // C23 (0: none yet)
+
+PRIVATE
+Shards* _shards_create(void)
+{
+    size_t count = _cpu_count() * SHARDS_PER_CPU;
+    if (count > SHARDS_MAX) {
+      count = SHARDS_MAX; }
+
+    Shards* s = (Shards*) calloc(1, sizeof(Shards));
+    if (!s) {
+        return nullptr; }
+    s->shards = (Shard*) calloc(count, sizeof(Shard));
+    if (!s->shards)
+    {   free(s);
+        return nullptr; }
+
+    for (size_t k = 0; k < count; k++) {
+      mtx_init(&s->shards[k].lock, mtx_plain); }
+    s->count = count;
+    atomic_init(&s->pending, 0);
+
+    return s;
+}
+
+PRIVATE
+void _shards_free(List* list)
+{
+    Shards* s = list->shards;
+    if (!s) {
+        return; }
+
+    for (size_t k = 0; k < s->count; k++) {
+      _value_free_chain(list, s->shards[k].first);
+      mtx_destroy(&s->shards[k].lock); }
+    free(s->shards);
+    free(s);
+}
+
+ // moves every shard's chain to the end of the list (lock held), shard by
+ // shard; a value whose add returned is always in
+PRIVATE
+void _shards_merge(List* list)
+{
+    Shards* s = list->shards;
+    if (atomic_load_explicit(&s->pending, memory_order_acquire) == 0) {
+        return; }
+
+    for (size_t k = 0; k < s->count; k++) {
+      Shard* sh = &s->shards[k];
+      mtx_lock(&sh->lock);
+      Value* first = sh->first;
+      Value* last = sh->last;
+      size_t n = sh->count;
+      sh->first = sh->last = nullptr;
+      sh->count = 0;
+      mtx_unlock(&sh->lock);
+
+      if (n > 0)
+      { atomic_fetch_sub_explicit(&s->pending, n, memory_order_relaxed);
+        _list_link_chain(list, first, last, n); }
+    }
+}
+
+PRIVATE
+long _ms_since(const struct timespec* then)
+{
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+
+    return (ts.tv_sec - then->tv_sec) * 1000 + (ts.tv_nsec - then->tv_nsec) / 1000000;
+}
+
+
+// LOCKING (and merging)
+
+static thread_local char _thread_id;    // C23 (its address tells threads apart)
+
+PRIVATE
+bool _list_locked_here(List* list)
+{
+    return atomic_load_explicit(&list->owner, memory_order_relaxed) == (uintptr_t)&_thread_id;
+}
+
+PRIVATE
+bool _list_lock(List* list)
+{
+    // no clock read unless we have to wait
+    if (mtx_trylock(&list->locked) != thrd_success)
+    { struct timespec t0, ts;
+      timespec_get(&t0, TIME_UTC);
+      _deadline(&ts, list->timeout);
+      if (mtx_timedlock(&list->locked, &ts) != thrd_success)
+      {   atomic_fetch_add_explicit(&list->timeouts, 1, memory_order_relaxed);
+          return false; }
+      timespec_get(&ts, TIME_UTC);
+      list->wait_ns += (uint64_t)(ts.tv_sec - t0.tv_sec) * 1000000000 + ts.tv_nsec - t0.tv_nsec;
+      list->contended++;
+    }
+    list->locks++;
+    if (list->depth++ == 0) {
+      atomic_store_explicit(&list->owner, (uintptr_t)&_thread_id, memory_order_relaxed); }
+
+    // LIST_SHARDED: whatever runs next sees all appends that returned
+    if (list->shards) {
+      _shards_merge(list); }
+    // shared: and all those published by other processes
+    if (list->shared)
+    {   _shared_reclaim(list);
+        list->length = atomic_load(&list->shared->length); }
+
+    return true;
+}
+
+PRIVATE
+void _list_unlock(List* list)
+{
+    if (--list->depth == 0) {
+      atomic_store_explicit(&list->owner, 0, memory_order_relaxed); }
+    mtx_unlock(&list->locked);
+}
+
+ // both or neither, in address order: two threads moving values between the
+ // same lists, each its own way, cannot deadlock
+PRIVATE
+bool _list_lock_pair(List* a, List* b)
+{
+    if ((uintptr_t)a > (uintptr_t)b)
+    {   List* t = a;
+        a = b;
+        b = t; }
+    if (!_list_lock(a)) {
+        return false; }
+    if (!_list_lock(b))
+    {   _list_unlock(a);
+        return false; }
+
+    return true;
+}
+
+ // for checks made before locking: unmerged LIST_SHARDED appends count too
+PRIVATE
+size_t _list_length(List* list)
+{
+    if ((list->shards || list->shared) && _list_lock(list)) {
+      _list_unlock(list); }
+
+    return list->length;
+}
+
+ // appends to the calling thread's shard, without the list lock
+PRIVATE
+errno_t _shard_add(List* list, const Value* v)
+{
+    Shards* s = list->shards;
+    if (_shard_ticket == 0) {
+      _shard_ticket = atomic_fetch_add(&_shard_tickets, 1) + 1; }
+    Shard* sh = &s->shards[(_shard_ticket - 1) % s->count];
+
+    Value* val = _value_dup(list, v);
+
+    mtx_lock(&sh->lock);
+    switch (sh->last == nullptr) {
+      case true:  sh->first = val;
+                  timespec_get(&sh->since, TIME_UTC); break;
+      case false: sh->last->next = val;
+    }
+    sh->last = val;
+    bool flush = (++sh->count >= SHARD_BATCH) ||
+                 (sh->count % 32 == 0 && _ms_since(&sh->since) >= SHARD_DELAY_MS);
+    atomic_fetch_add_explicit(&s->pending, 1, memory_order_release);
+    mtx_unlock(&sh->lock);
+
+    // someone waiting for it? (pairs with the fence in "list_wait_length()")
+    atomic_thread_fence(memory_order_seq_cst);
+    flush |= (atomic_load_explicit(&list->waiters, memory_order_relaxed) > 0);
+
+    // locking is merging
+    if (flush && _list_lock(list)) {
+      _list_unlock(list); }
+
+    return EXIT_SUCCESS;
+}
+
+PRIVATE
+errno_t _store_add_value(List* list, const Value* v)
+{
+    if (!_list_lock(list)) {
+        return errno = EAGAIN; }
+    size_t pos = (v->idx == IDX_END) ? list->length : v->idx;
+    if (pos > list->length)
+    {   _list_unlock(list);
+        return errno = EINVAL; }
+    Value c = *v;
+    if (!_value_own(list, &c))
+    {   _list_unlock(list);
+        return errno = ENOMEM; }
+
+    // shift the shorter side, emplace our value
+    bool front = (list->gap && pos < list->length / 2);
+    if (front ? !_store_thaw(list, -1, pos + 1, list->capacity)
+              : !_store_reserve(list, 1) ||
+                !_store_thaw(list, pos, list->length + 1, list->capacity))
+    {   _list_unlock(list);
+        return errno = ENOMEM; }
+    if (!_journal_insert(list, pos, &c))
+    {   _list_unlock(list);
+        return errno = EIO; }
+    if (front) {
+      _store_move_front(list, pos, -1); }
+    else {
+      _store_move(list, pos, pos + 1); }
+    _index_shift(list, pos, +1);
+    _store_put(list, pos, &c);
+    _index_insert(list, pos, nullptr);
+
+    list->length++;
+    errno_t e = _journal_commit(list);
+    _list_unlock(list);
+
+    return e;
+}
+
+PRIVATE
+errno_t _list_add_value(List* list, const Value* v)
+{
+    if (list->shared && v->idx == IDX_END) {
+      return _shared_add(list, v); }
+    if (list->map) {
+        return errno = EROFS; }
+    if (list->queue)
+    {   Value c = *v;
+        if (_value_long_blob(v)) {        // no lock, so no arena to own it
+            return errno = EINVAL; }
+        return _queue_push(list, &c); }
+    if (list->shards && v->idx == IDX_END && !_value_long_blob(v)) {
+      return _shard_add(list, v); }
+    if (list->flags & LIST_COMPACT) {
+      return _store_add_value(list, v); }
+
+    Value* val = _value_dup(list, v);
+
+    if (!_list_lock(list))
+    {   free(val);
+        return errno = EAGAIN; }
+    size_t pos = (val->idx == IDX_END) ? list->length : val->idx;
+    if (pos > list->length || !_value_own(list, val))
+    {   _list_unlock(list);
+        free(val);
+        return errno = (pos > list->length) ? EINVAL : ENOMEM; }
+    if (!_journal_insert(list, pos, val))
+    {   _list_unlock(list);
+        free(val);
+        return errno = EIO; }
+
+    // emplace our value between its neighbours, re-index others
+    Value* next = (pos == list->length) ? nullptr : _list_node(list, pos);
+    Value* prev = next ? next->prev : list->last;
+    _list_reindex(list, pos, prev, next, +1);
+    val->idx = pos + list->origin;
+    val->prev = prev;
+    val->next = next;
+    switch (prev == nullptr) {
+      case true:  list->first = val; break;
+      case false: prev->next = val;
+    }
+    switch (next == nullptr) {
+      case true:  list->last = val; break;
+      case false: next->prev = val;
+    }
+    _index_insert(list, pos, val);
+
+    list->length++;
+    errno_t e = _journal_commit(list);
+    _list_unlock(list);
+
+    return e;
+}
+
+PRIVATE
+errno_t _list_add_chain(List* list, Value* first, Value* last, size_t n)
+{
+    if (list->map)
+    {   _value_free_chain(list, first);
+        return errno = EROFS; }
+    if (list->queue)
+    { errno_t e = EXIT_SUCCESS;
+      for (Value* c = first; !e && c != nullptr; c = c->next) {
+        e = _queue_push(list, c); }
+      _value_free_chain(list, first);
+      return e;
+    }
+    if (!_list_lock(list))
+    {   _value_free_chain(list, first);
+        return errno = EAGAIN; }
+
+    errno_t e = _list_link_chain(list, first, last, n);
+    _list_unlock(list);
+
+    return e;
+}
+
+PRIVATE
+errno_t _list_del_value(List* list, size_t idx)
+{
+    if (list->map) {
+        return errno = EROFS; }
+    if (!_list_lock(list)) {
+        return errno = EAGAIN; }
+    if (idx >= list->length)        // others deleted meanwhile
+    {   _list_unlock(list);
+        return errno = EINVAL; }
+
+    if (list->flags & LIST_COMPACT)
+    { bool front = (idx < list->length / 2);
+      if (front ? !_store_thaw(list, 1, idx + 1, list->capacity)
+                : !_store_thaw(list, idx, list->length - 1, list->capacity))
+      {   _list_unlock(list);
+          return errno = ENOMEM; }
+      if (!_journal_delete(list, idx))
+      {   _list_unlock(list);
+          return errno = EIO; }
+      _index_remove(list, idx, nullptr);
+      // shift the shorter side
+      if (front) {
+        _store_move_front(list, idx, +1); }
+      else {
+        _store_move(list, idx + 1, idx); }
+      _index_shift(list, idx, -1);    // "idx" one is gone already
+      list->length--;
+      errno_t e = _journal_commit(list);
+      _list_unlock(list);
+      return e;
+    }
+
+    if (!_journal_delete(list, idx))
+    {   _list_unlock(list);
+        return errno = EIO; }
+
+    // unlink the target from its neighbours, re-index others
+    Value* n = _list_node(list, idx);
+    switch (n->prev == nullptr) {
+      case true:  list->first = n->next; break;
+      case false: n->prev->next = n->next;
+    }
+    switch (n->next == nullptr) {
+      case true:  list->last = n->prev; break;
+      case false: n->next->prev = n->prev;
+    }
+    _list_reindex(list, idx, n->prev, n->next, -1);
+    _index_remove(list, idx, n);
+    _value_destroy(list, n);
+
+    list->length--;
+    errno_t e = _journal_commit(list);
+    _list_unlock(list);
+
+    return e;
+}
+
+PRIVATE
+errno_t _list_pop_value(List* list, bool back, Value* v, char* keep)
+{
+    if (list->queue) {
+        return back ? (errno = EINVAL) : _queue_pop(list, v); }
+    if (list->map) {
+        return errno = EROFS; }
+    if (!_list_lock(list)) {
+        return errno = EAGAIN; }
+    if (list->length == 0)
+    {   _list_unlock(list);
+        return errno = EINVAL; }
+
+    // copied before it goes (the lock is recursive)
+    size_t idx = back ? list->length - 1 : 0;
+    Cursor at;
+    *v = *_list_seek(list, &at, idx);
+    if ((list->flags & LIST_COMPACT) && list->tags[idx] == T_SSTR)
+    {   memcpy(keep, v->s, sizeof(Payload));  // its slot gets reused
+        v->s = keep; }
+    errno_t e = _list_del_value(list, idx);
+
+    _list_unlock(list);
+
+    return e;
+}
+
+PRIVATE
+errno_t _list_pop_string(List* list, bool back, char** s)
+{
+    Value v;
+    char keep[sizeof(Payload)];
+    if (_list_pop_value(list, back, &v, keep)) {
+        return errno; }
+
+    // an inline string was only in "keep": the caller gets a copy to free
+    if (v.t == T_STRING && v.s == keep)
+    {   if (!(*s = strdup(keep))) {
+            return errno = ENOMEM; }
+        return errno = ESTRING; }
+
+    return errno = _value_get(&v, s);
+}
+
+PRIVATE
+errno_t _list_sort(List* list, ListCompare cmp, bool stable)
+{
+    if (list->map) {
+        return errno = EROFS; }
+    if (!_list_lock(list)) {
+        return errno = EAGAIN; }
+
+    size_t n = list->length;
+    if (n < 2 || !_journal_ok(list))
+    {   _list_unlock(list);
+        return (n < 2) ? EXIT_SUCCESS : (errno = EIO); }
+
+    bool compact = (list->flags & LIST_COMPACT);
+    SortItem* a = (SortItem*) malloc(n * sizeof(SortItem));
+    SortItem* tmp = (SortItem*) malloc(n * sizeof(SortItem));
+    Value* cells = nullptr;
+    uint8_t* tags = nullptr;
+    Payload* data = nullptr;
+    if (compact) {
+      cells = (Value*) malloc(n * sizeof(Value));
+      tags = (uint8_t*) malloc(list->capacity);
+      data = (Payload*) malloc(list->capacity * sizeof(Payload));
+    }
+    if (!a || !tmp || (compact && (!cells || !tags || !data)))
+    {   free(a); free(tmp); free(cells); free(tags); free(data);
+        _list_unlock(list);
+        return errno = ENOMEM; }
+
+    if (compact) {
+      for (size_t i = 0; i < n; i++) {
+        _store_get(list, i, &cells[i]);
+        _item_set(&a[i], &cells[i]);
+      }
+    } else {
+      Value* c = list->first;
+      for (size_t i = 0; i < n; i++, c = c->next) {
+        _item_set(&a[i], c); }
+    }
+
+    SortItem* sorted = _sort_items(a, tmp, n, cmp, stable);
+
+    if (compact) {
+      // inline strings still point to the old arrays: encode into new ones
+      uint8_t* old_tags = list->tags - list->gap;
+      Payload* old_data = list->data - list->gap;
+      list->tags = tags;
+      list->data = data;
+      list->gap = 0;
+      for (size_t i = 0; i < n; i++) {
+        _store_put(list, i, sorted[i].v); }
+      _store_free(list->frozen, old_tags, old_data);
+      list->frozen = nullptr;
+      if (list->flags & LIST_HASHINDEX) {
+        _index_rebuild(list); }
+    } else {
+      // relink and re-index all nodes (index entries follow their node)
+      for (size_t i = 0; i < n; i++) {
+        sorted[i].v->idx = i;
+        sorted[i].v->next = (i + 1 < n) ? sorted[i+1].v : nullptr;
+        sorted[i].v->prev = (i > 0) ? sorted[i-1].v : nullptr;
+      }
+      list->origin = 0;
+      list->first = sorted[0].v;
+      list->last = sorted[n-1].v;
+    }
+
+    free(a);
+    free(tmp);
+    free(cells);
+    // one record per value would be a full copy anyway: checkpoint instead
+    // (failing that, older records would replay against another order)
+    _list_notify(list);
+    errno_t e = list->journal ? _journal_checkpoint(list) : EXIT_SUCCESS;
+    if (e) {
+      _journal_fail(list->journal); }
+    _list_unlock(list);
+
+    return e;
+}
+
+ // runs "job" over all values: one range per pool thread or so, each with
+ // its own copy of "acc" when reducing (combined in order at the end)
+PRIVATE
+errno_t _list_parallel(List* list, ParallelJob* job, void* acc)
+{
+    if (job->fn && list->map) {
+        return errno = EROFS; }
+    if (!_list_lock(list)) {
+        return errno = EAGAIN; }
+
+    if (job->fn && !_journal_ok(list))
+    {   _list_unlock(list);
+        return errno = EIO; }
+
+    // values get written in place: no sharing arrays with snapshots then
+    size_t n = list->length;
+    if (job->fn && !_store_thaw(list, 0, n, list->capacity))
+    {   _list_unlock(list);
+        return errno = ENOMEM; }
+
+    job->list = list;
+    job->ranges = 1;
+    if (n >= PARALLEL_MIN)
+    { size_t max = 4 * _pool_size();    // some slack for uneven ranges
+      job->ranges = n / PARALLEL_RANGE;
+      job->ranges = (job->ranges > max) ? max : job->ranges; }
+    atomic_init(&job->changed, false);
+
+    if (!(list->flags & LIST_COMPACT)) {
+      job->starts = (Value**) malloc(job->ranges * sizeof(Value*)); }
+    if (acc) {
+      job->accs = (uint8_t*) malloc(job->ranges * job->size); }
+    if ((!(list->flags & LIST_COMPACT) && !job->starts) || (acc && !job->accs))
+    {   free(job->starts);
+        free(job->accs);
+        _list_unlock(list);
+        return errno = ENOMEM; }
+
+    // one walk to find where linked ranges start
+    Value* c = list->first;
+    for (size_t k = 0, pos = 0; job->starts && k < job->ranges; k++) {
+      for (; pos < k * n / job->ranges; pos++) {
+        c = c->next; }
+      job->starts[k] = c;
+    }
+    for (size_t k = 0; acc && k < job->ranges; k++) {
+      memcpy(job->accs + k * job->size, acc, job->size); }
+
+    _pool_run(_parallel_range, job, job->ranges);
+
+    errno_t e = EXIT_SUCCESS;
+    if (acc)
+    { for (size_t k = 1; k < job->ranges; k++) {
+        job->combine(job->accs, job->accs + k * job->size, job->ctx); }
+      memcpy(acc, job->accs, job->size);
+    }
+    else if (atomic_load(&job->changed))
+    { if (list->flags & LIST_HASHINDEX) {
+        _index_rebuild(list); }
+      _list_notify(list);
+      // like sorting: a checkpoint, rather than a record per value
+      e = list->journal ? _journal_checkpoint(list) : EXIT_SUCCESS;
+      if (e) {
+        _journal_fail(list->journal); }
+    }
+    _list_unlock(list);
+
+    free(job->starts);
+    free(job->accs);
+
+    return e;
+}
+
+PRIVATE
+void _list_clear(List* list)
+{
+    _value_free_chain(list, list->first);
+    list->first = list->last = nullptr;
+    list->length = 0;
+    _index_free(list);
+}
+
+ // one record at "*pos", applied if complete and intact
+PRIVATE
+bool _journal_apply(List* list, const uint8_t* p, size_t size, size_t* pos)
+{
+    size_t start = *pos;
+    uint64_t idx, x = 0;
+    Value v = { .t = T_UNDEF };
+    const char* s = nullptr;
+
+    if (*pos >= size) {
+        return false; }
+    uint8_t op = p[(*pos)++];
+    if (!_varint_get(p, size, pos, &idx)) {
+        return false; }
+
+    if (op == J_INSERT) {
+      if (*pos >= size) {
+          return false; }
+      v.t = (ValueType)p[(*pos)++];
+      switch (v.t) {
+        case T_INTEGER: if (!_varint_get(p, size, pos, &x)) {
+                          return false; }
+                        v.i = (int)(int64_t)((x >> 1) ^ (~(x & 1) + 1));
+                        break;
+        case T_BOOLEAN: if (*pos >= size) {
+                          return false; }
+                        v.b = p[(*pos)++];
+                        break;
+        case T_FLOAT  : if (size - *pos < 8) {
+                          return false; }
+                        x = _get_le(p + *pos, 8);
+                        memcpy(&v.f, &x, sizeof(x));
+                        *pos += 8;
+                        break;
+        case T_STRING : if (!_varint_get(p, size, pos, &x) || x > size - *pos + 1) {
+                          return false; }
+                        s = (const char*)p + *pos;
+                        *pos += x ? x - 1 : 0;
+                        break;
+        case T_INT64  : if (!_varint_get(p, size, pos, &x)) {
+                          return false; }
+                        v.l = (int64_t)((x >> 1) ^ (~(x & 1) + 1));
+                        break;
+        case T_BLOB   : if (!_varint_get(p, size, pos, &x) || x > size - *pos || x > UINT32_MAX) {
+                          return false; }
+                        _value_set_blob(&v, (ListBlob){ p + *pos, (size_t)x });
+                        *pos += x;        // (copied by the list, when added)
+                        break;
+        default       : return false;
+      }
+    }
+
+    if (size - *pos < 4 ||
+        _get_le(p + *pos, 4) != _fnv32(FNV32_INIT, p + start, *pos - start)) {
+        return false; }
+    *pos += 4;
+
+    switch (op) {
+      case J_INSERT: if (idx > list->length) {
+                       return false; }
+                     if (v.t == T_STRING && x &&
+                         !(v.s = _arena_strndup(list, s, x - 1))) {
+                         return false; }
+                     v.idx = idx;
+                     return _list_add_value(list, &v) == EXIT_SUCCESS;
+      case J_DELETE: return (idx < list->length) &&
+                            (_list_del_value(list, idx) == EXIT_SUCCESS);
+      case J_CLEAR : _list_clear(list);
+                     return true;
+      default      : return false;
+    }
+}
+
+PRIVATE
+errno_t _list_get_value(List* list, size_t idx, Value** val)
+{
+    if (!_list_lock(list))
+    {   free(*val);
+        return errno = EAGAIN; }
+
+    Cursor at;
+    memcpy((void*)*val, (void*)_list_seek(list, &at, idx), sizeof(Value));
+
+    _list_unlock(list);
+
+    return EXIT_SUCCESS;
+}
+
+
+// PUBLIC FUNCTION IMPLEMENTATIONS
+
+PUBLIC
+List* list_create(unsigned int timeout)
+{
+    return list_create_flags(timeout, LIST_DEFAULT);
+}
+
+PUBLIC
+List* list_create_flags(unsigned int timeout, unsigned int flags)
+{
+    // no per-value text cache without per-value nodes
+    if (flags & LIST_COMPACT) {
+      flags &= ~LIST_STRCACHE; }
+
+    auto l = (List*) calloc(1, sizeof(List)); // C23
+    l->timeout = timeout;
+    l->flags = flags;
+    mtx_init(&l->locked, mtx_recursive | mtx_timed);
+    cnd_init(&l->changed);
+    atomic_init(&l->waiters, 0);
+    atomic_init(&l->timeouts, 0);
+
+    if ((flags & LIST_SHARDED) && !(l->shards = _shards_create()))
+    {   cnd_destroy(&l->changed);
+        mtx_destroy(&l->locked);
+        free(l);
+        errno = ENOMEM; return nullptr; }
+
+    return l;
+}
+
+PUBLIC
+List* list_create_shared(const char* name, size_t capacity)
+{
+    if (!name || !*name || capacity > SIZE_MAX / (SHARED_HEAP_PER_VALUE + 16)) {
+        errno = EINVAL; return nullptr; }
+
+    // POSIX wants "/name", Windows any
+    char* path = (char*) malloc(strlen(name) + 2);
+    if (!path) {
+        errno = ENOMEM; return nullptr; }
+    sprintf(path, (name[0] == '/') ? "%s" : "/%s", name);
+
+    size_t tags, data, heap;
+    size_t size = capacity ? _shared_layout(capacity, &tags, &data, &heap) : 0;
+    bool created;
+    uint8_t* p = (uint8_t*) _shared_map(path, &size, &created);
+    if (!p)
+    {   free(path);
+        return nullptr; }
+
+    SharedHeader* h = (SharedHeader*) p;
+    if (created) {
+      h->version = SHARED_VERSION;
+      h->capacity = capacity;
+      h->heap_size = capacity * SHARED_HEAP_PER_VALUE;
+      atomic_store(&h->magic, SHARED_MAGIC);
+    }
+    // or wait for its creator, then trust nothing it says
+    for (size_t us = 0; us < SHARED_WAIT_US && atomic_load(&h->magic) != SHARED_MAGIC; us += 1000) {
+      _shared_sleep(); }
+    if (atomic_load(&h->magic) != SHARED_MAGIC || h->version != SHARED_VERSION ||
+        h->capacity > SIZE_MAX / (SHARED_HEAP_PER_VALUE + 16) ||
+        _shared_layout(h->capacity, &tags, &data, &heap) > size)
+    {   _file_unmap(p, size);
+        free(path);
+        errno = EINVAL; return nullptr; }
+    atomic_fetch_add(&h->attached, 1);
+
+    List* l = list_create_flags(SHARED_WAIT_US, LIST_COMPACT);
+    l->map = p;
+    l->map_size = size;
+    l->tags = p + tags;
+    l->data = (Payload*)(p + data);
+    l->capacity = h->capacity;
+    l->heap = (const char*)(p + heap);
+    l->heap_size = h->heap_size;
+    l->shared = h;
+    l->shared_name = path;
+    l->length = atomic_load(&h->length);
+
+    return l;
+}
+
+PUBLIC
+List* list_create_queue(unsigned int timeout, size_t capacity)
+{
+    if (capacity == 0) {
+        errno = EINVAL; return nullptr; }
+
+    List* l = list_create(timeout);
+    l->queue = _queue_create(capacity);
+    if (!l->queue)
+    {   list_destroy(l);
+        errno = ENOMEM; return nullptr; }
+
+    return l;
+}
+
+PUBLIC
 errno_t list_add_int(List* l, int v) {
     return LIST_INSERT_CHECK(l, v); }
 
 PUBLIC
-errno_t list_add_bool(List* l, bool v) {
-    return LIST_INSERT_CHECK(l, v); }
- 
+errno_t list_add_bool(List* l, bool v) {
+    return LIST_INSERT_CHECK(l, v); }
+ 
+PUBLIC
+errno_t list_add_float(List* l, double v) {
+    return LIST_INSERT_CHECK(l, v); }
+
+PUBLIC
+errno_t list_add_string(List* l, char* v) {
+    return LIST_INSERT_CHECK(l, v); }
+
+PUBLIC
+errno_t list_add_int64(List* l, int64_t v) {
+    return LIST_INSERT_CHECK(l, v); }
+
+PUBLIC
+errno_t list_add_blob(List* l, ListBlob v) {
+    return LIST_INSERT_CHECK(l, v); }
+
+PUBLIC
+errno_t list_insert_int(List* list, size_t idx, int i) {
+    LIST_INSERT_CHECK_IMPL(list, idx, i); }
+
+PUBLIC
+errno_t list_insert_bool(List* list, size_t idx, bool b) {
+    LIST_INSERT_CHECK_IMPL(list, idx, b); }
+
+PUBLIC
+errno_t list_insert_float(List* list, size_t idx, double f) {
+    LIST_INSERT_CHECK_IMPL(list, idx, f); }
+
+PUBLIC
+errno_t list_insert_string(List* list, size_t idx, char* s) {
+    LIST_INSERT_CHECK_IMPL(list, idx, s); }
+
+PUBLIC
+errno_t list_insert_int64(List* list, size_t idx, int64_t l) {
+    LIST_INSERT_CHECK_IMPL(list, idx, l); }
+
+PUBLIC
+errno_t list_insert_blob(List* list, size_t idx, ListBlob b) {
+    if (b.size > UINT32_MAX || (!b.data && b.size > 0)) {
+        return errno = EINVAL; }
+    LIST_INSERT_CHECK_IMPL(list, idx, b); }
+
+PUBLIC
+errno_t list_get_int(List* list, size_t idx, int* i) {
+    LIST_GET_CHECK_IMPL(list, idx, i); }
+
+PUBLIC
+errno_t list_get_bool(List* list, size_t idx, bool* b) {
+    LIST_GET_CHECK_IMPL(list, idx, b); }
+
+PUBLIC
+errno_t list_get_float(List* list, size_t idx, double* f) {
+    LIST_GET_CHECK_IMPL(list, idx, f); }
+
+PUBLIC
+errno_t list_get_string(List* list, size_t idx, char** s) {
+    LIST_GET_CHECK_IMPL(list, idx, s); }
+
+PUBLIC
+errno_t list_get_int64(List* list, size_t idx, int64_t* l) {
+    LIST_GET_CHECK_IMPL(list, idx, l); }
+
+PUBLIC
+errno_t list_get_Type(List* list, size_t idx, void* n) {
+    LIST_GET_CHECK_IMPL(list, idx, n); }
+
+ // points into the list itself, not into a copy of the value
+PUBLIC
+errno_t list_get_blob(List* list, size_t idx, ListBlob* b)
+{
+    if (!list || !b || _list_length(list) <= idx) {
+        return errno = EINVAL; }
+    if (!_list_lock(list)) {
+        return errno = EAGAIN; }
+
+    errno_t e = EINVAL;
+    Cursor at;
+    if (idx < list->length) {
+      Value* v = _list_seek(list, &at, idx);
+      e = _value_get_blob(v, b);
+      if (v == &at.scratch && b->data == v->c) {
+        b->data = list->data[idx].c; }   // inline in its slot
+    }
+
+    _list_unlock(list);
+
+    return errno = e;
+}
+
+PUBLIC
+errno_t list_get_string_buf(List* list, size_t idx, char* buf, size_t len)
+{
+    if (!list || !buf || _list_length(list) <= idx) {
+        return errno = EINVAL; }
+    if (!_list_lock(list)) {
+        return errno = EAGAIN; }
+
+    errno_t e = EINVAL;
+    Cursor at;
+    if (idx < list->length) {
+      e = _value_get_string_buf(list, _list_seek(list, &at, idx), buf, len); }
+
+    _list_unlock(list);
+
+    return errno = e;
+}
+
+PUBLIC
+errno_t list_add_ints(List* list, const int* a, size_t n) {
+    LIST_ADD_ARRAY_CHECK_IMPL(list, a, n); }
+
+PUBLIC
+errno_t list_add_floats(List* list, const double* a, size_t n) {
+    LIST_ADD_ARRAY_CHECK_IMPL(list, a, n); }
+
+PRIVATE
+errno_t _store_append_store(List* list, List* other)
+{
+    // both locked, room reserved: detach all values from "other"
+    uint8_t* tags = other->tags;
+    Payload* data = other->data;
+    size_t n = other->length;
+    size_t gap = other->gap;
+    Frozen* frozen = other->frozen;
+    Arena* arena = other->arena;
+    other->tags = nullptr;
+    other->data = nullptr;
+    other->frozen = nullptr;
+    other->length = other->capacity = other->gap = 0;
+    other->arena = nullptr;
+    _index_free(other);
+    errno_t e = _journal_commit(other);
+
+    _list_unlock(other);
+
+    _arena_adopt(list, arena);
+    memcpy(&list->tags[list->length], tags, n);
+    memcpy(&list->data[list->length], data, n * sizeof(Payload));
+    // (past the length, values are not in the list until journaled)
+    for (size_t k = 0; k < n; k++) {
+      Value v;
+      _store_get(list, list->length, &v);
+      if (!_journal_insert(list, list->length, &v))
+      {   e = e ? e : (errno = EIO);
+          break; }
+      _index_insert(list, list->length++, nullptr); }
+    errno_t j = _journal_commit(list);
+    e = e ? e : j;
+    _list_unlock(list);
+
+    _store_free(frozen, tags - gap, data - gap);
+
+    return e;
+}
+
+PUBLIC
+errno_t list_append_list(List* list, List* other)
+{
+    if (!list || !other || list == other) {
+        return errno = EINVAL; }
+    if ((list->flags ^ other->flags) & LIST_COMPACT) {
+        return errno = EINVAL; }   // inline strings cannot leave their storage
+    if (list->map || other->map) {
+        return errno = EROFS; }
+    // nothing leaves "other" until both are locked (and there is room)
+    if (!_list_lock_pair(list, other)) {
+        return errno = EAGAIN; }
+    errno_t e = EXIT_SUCCESS;
+    if ((other->flags & LIST_COMPACT) && !_store_reserve(list, other->length)) {
+      e = ENOMEM; }
+    else if (!_journal_clear(other)) {
+      e = EIO; }
+    if (e)
+    {   _list_unlock(other);
+        _list_unlock(list);
+        return errno = e; }
+
+    if (other->flags & LIST_COMPACT) {
+      return _store_append_store(list, other); }
+
+    // detach all values from "other"
+    Value* first = other->first;
+    Value* last = other->last;
+    size_t n = other->length;
+    Arena* arena = other->arena;
+    other->first = other->last = nullptr;
+    other->length = 0;
+    other->arena = nullptr;
+    _index_free(other);
+    e = _journal_commit(other);
+
+    _list_unlock(other);
+
+    for (Value** c = &first; *c != nullptr; c = &(*c)->next) {
+      *c = _value_move(other, list, *c);
+      last = *c;
+    }
+
+    // strings first: once linked, the values may be read
+    _arena_adopt(list, arena);
+    errno_t j = _list_add_chain(list, first, last, n);   // (still locked)
+    _list_unlock(list);
+
+    return e ? e : j;
+}
+
+PUBLIC
+errno_t list_get_ints(List* list, size_t idx, size_t n, int* a) {
+    LIST_GET_ARRAY_CHECK_IMPL(list, idx, n, a); }
+
+PUBLIC
+errno_t list_get_bools(List* list, size_t idx, size_t n, bool* a) {
+    LIST_GET_ARRAY_CHECK_IMPL(list, idx, n, a); }
+
+PUBLIC
+errno_t list_get_floats(List* list, size_t idx, size_t n, double* a) {
+    LIST_GET_ARRAY_CHECK_IMPL(list, idx, n, a); }
+
+PUBLIC
+errno_t list_sum_float(List* list, double* sum)
+{
+    if (!list || !sum) {
+        return errno = EINVAL; }
+    if (!_list_lock(list)) {
+        return errno = EAGAIN; }
+
+    SumFloat c = { .sum = 0.0, .e = EXIT_SUCCESS };
+    _list_columns(list, _column_sum_float, &c);
+    *sum = c.sum;
+
+    _list_unlock(list);
+
+    return errno = c.e;
+}
+
+PUBLIC
+errno_t list_minmax_int(List* list, int* min, int* max)
+{
+    if (!list || !min || !max) {
+        return errno = EINVAL; }
+    if (!_list_lock(list)) {
+        return errno = EAGAIN; }
+
+    MinMaxInt c = { .min = INT_MAX, .max = INT_MIN, .seen = 0, .e = EXIT_SUCCESS };
+    _list_columns(list, _column_minmax_int, &c);
+    if (c.seen == 0) {
+      c.e = EINVAL;
+    } else {
+      *min = c.min;
+      *max = c.max;
+    }
+
+    _list_unlock(list);
+
+    return errno = c.e;
+}
+
+PUBLIC
+errno_t list_count_type(List* list, errno_t type, size_t* count)
+{
+    if (!list || !count) {
+        return errno = EINVAL; }
+
+    CountTag c = { .count = 0 };
+    switch (type) {
+      case EINTEGER: c.a = c.b = T_INTEGER;     break;
+      case EBOOLEAN: c.a = c.b = T_BOOLEAN;     break;
+      case EFLOAT  : c.a = c.b = T_FLOAT;       break;
+      case ESTRING : c.a = T_STRING; c.b = T_SSTR; break;
+      case EINT64  : c.a = c.b = T_INT64;       break;
+      case EBLOB   : c.a = T_BLOB; c.b = T_SBLOB;  break;
+      default      : return errno = EINVAL;
+    }
+
+    if (!_list_lock(list)) {
+        return errno = EAGAIN; }
+
+    _list_columns(list, _column_count_tag, &c);
+    *count = c.count;
+
+    _list_unlock(list);
+
+    return EXIT_SUCCESS;
+}
+
+PRIVATE
+errno_t _list_find_value(List* list, const Value* key, size_t* idx)
+{
+    if (!_list_lock(list)) {
+        return errno = EAGAIN; }
+
+    bool found = false;
+    if (list->flags & LIST_HASHINDEX) {
+      found = _index_find(list, key, idx);
+    } else if (key->t == T_INTEGER) {
+      FindInt c = { .x = key->i, .found = false };
+      _list_columns(list, _column_find_int, &c);
+      if ((found = c.found)) {
+        *idx = c.idx; }
+    } else if (list->length > 0) {
+      Cursor at;
+      for (Value* c = _list_seek(list, &at, 0); ; c = _list_step(list, &at)) {
+        if (_value_equal(c, key)) {
+          *idx = at.idx; found = true; break; }
+        if (at.idx + 1 == list->length) {
+          break; }
+      }
+    }
+
+    _list_unlock(list);
+
+    return found ? EXIT_SUCCESS : (errno = ENOENT);
+}
+
+PUBLIC
+errno_t list_find_int(List* list, int i, size_t* idx) {
+    LIST_FIND_CHECK_IMPL(list, i, idx); }
+
+PUBLIC
+errno_t list_find_bool(List* list, bool b, size_t* idx) {
+    LIST_FIND_CHECK_IMPL(list, b, idx); }
+
+PUBLIC
+errno_t list_find_float(List* list, double f, size_t* idx) {
+    LIST_FIND_CHECK_IMPL(list, f, idx); }
+
+PUBLIC
+errno_t list_find_string(List* list, const char* s, size_t* idx) {
+    LIST_FIND_CHECK_IMPL(list, (char*)s, idx); }
+
+PUBLIC
+errno_t list_find_int64(List* list, int64_t l, size_t* idx) {
+    LIST_FIND_CHECK_IMPL(list, l, idx); }
+
+PUBLIC
+errno_t list_find_blob(List* list, ListBlob b, size_t* idx) {
+    if (b.size > UINT32_MAX || (!b.data && b.size > 0)) {
+        return errno = EINVAL; }
+    LIST_FIND_CHECK_IMPL(list, b, idx); }
+
+PUBLIC
+errno_t list_sort(List* list, ListCompare cmp)
+{
+    if (!list) {
+        return errno = EINVAL; }
+
+    return _list_sort(list, cmp, false);
+}
+
+PUBLIC
+errno_t list_sort_stable(List* list, ListCompare cmp)
+{
+    if (!list) {
+        return errno = EINVAL; }
+
+    return _list_sort(list, cmp, true);
+}
+
 PUBLIC
-errno_t list_add_float(List* l, double v) {
-    return LIST_INSERT_CHECK(l, v); }
+errno_t list_foreach_parallel(List* list, ListForeach fn, void* ctx)
+{
+    if (!list || !fn) {
+        return errno = EINVAL; }
+    ParallelJob job = { .fn = fn, .ctx = ctx };
+    return _list_parallel(list, &job, nullptr);
+}
 
 PUBLIC
-errno_t list_add_string(List* l, char* v) {
-    return LIST_INSERT_CHECK(l, v); }
+errno_t list_reduce_parallel(List* list, ListReduce fn, ListCombine combine,
+                             void* acc, size_t size, void* ctx)
+{
+    if (!list || !fn || !combine || !acc || size == 0) {
+        return errno = EINVAL; }
+    ParallelJob job = { .reduce = fn, .combine = combine, .ctx = ctx, .size = size };
+    return _list_parallel(list, &job, acc);
+}
 
 PUBLIC
-errno_t list_insert_int(List* list, size_t idx, int i) {
-    LIST_INSERT_CHECK_IMPL(list, idx, i); }
+errno_t list_parse_numeric(List* list)
+{
+    if (!list) {
+        return errno = EINVAL; }
+    ParallelJob job = { .fn = _value_parse_numeric };
+    return _list_parallel(list, &job, nullptr);
+}
 
 PUBLIC
-errno_t list_insert_bool(List* list, size_t idx, bool b) {
-    LIST_INSERT_CHECK_IMPL(list, idx, b); }
+int list_compare(const ListValue* a, const ListValue* b)
+{
+    return _value_compare(a, b);
+}
 
 PUBLIC
-errno_t list_insert_float(List* list, size_t idx, double f) {
-    LIST_INSERT_CHECK_IMPL(list, idx, f); }
+errno_t list_value_set_int(ListValue* v, int i) {
+    LIST_VALUE_SET_CHECK_IMPL(v, i); }
 
 PUBLIC
-errno_t list_insert_string(List* list, size_t idx, char* s) {
-    LIST_INSERT_CHECK_IMPL(list, idx, s); }
+errno_t list_value_set_bool(ListValue* v, bool b) {
+    LIST_VALUE_SET_CHECK_IMPL(v, b); }
 
 PUBLIC
-errno_t list_get_int(List* list, size_t idx, int* i) {
-    LIST_GET_CHECK_IMPL(list, idx, i); }
+errno_t list_value_set_float(ListValue* v, double f) {
+    LIST_VALUE_SET_CHECK_IMPL(v, f); }
 
 PUBLIC
-errno_t list_get_bool(List* list, size_t idx, bool* b) {
-    LIST_GET_CHECK_IMPL(list, idx, b); }
+errno_t list_value_set_string(ListValue* v, char* s) {
+    LIST_VALUE_SET_CHECK_IMPL(v, s); }
 
 PUBLIC
-errno_t list_get_float(List* list, size_t idx, double* f) {
-    LIST_GET_CHECK_IMPL(list, idx, f); }
+errno_t list_value_set_int64(ListValue* v, int64_t l) {
+    LIST_VALUE_SET_CHECK_IMPL(v, l); }
 
 PUBLIC
-errno_t list_get_string(List* list, size_t idx, char** s) {
-    LIST_GET_CHECK_IMPL(list, idx, s); }
+errno_t list_value_get_int(const ListValue* v, int* i) {
+    LIST_VALUE_CHECK_IMPL(v, i); }
 
 PUBLIC
-errno_t list_get_Type(List* list, size_t idx, void* n) {
-    LIST_GET_CHECK_IMPL(list, idx, n); }
+errno_t list_value_get_bool(const ListValue* v, bool* b) {
+    LIST_VALUE_CHECK_IMPL(v, b); }
+
+PUBLIC
+errno_t list_value_get_float(const ListValue* v, double* f) {
+    LIST_VALUE_CHECK_IMPL(v, f); }
+
+PUBLIC
+errno_t list_value_get_string(const ListValue* v, char** s) {
+    LIST_VALUE_CHECK_IMPL(v, s); }
+
+PUBLIC
+errno_t list_value_get_int64(const ListValue* v, int64_t* l) {
+    LIST_VALUE_CHECK_IMPL(v, l); }
+
+PUBLIC
+errno_t list_value_get_blob(const ListValue* v, ListBlob* b) {
+    LIST_VALUE_CHECK_IMPL(v, b); }
+
+PUBLIC
+errno_t list_value_get_Type(const ListValue* v, void* n) {
+    LIST_VALUE_CHECK_IMPL(v, n); }
+
+PUBLIC
+errno_t list_save(List* list, const char* path)
+{
+    if (!list || !path) {
+        return errno = EINVAL; }
+
+    FILE* f = fopen(path, "wb");
+    if (!f) {
+        return errno; }
+    if (!_list_lock(list))
+    {   fclose(f);
+        return errno = EAGAIN; }
+
+    bool ok = _file_write(list, f, 0);
+
+    _list_unlock(list);
+
+    if (fclose(f) != 0) {
+      ok = false; }
+
+    return ok ? EXIT_SUCCESS : (errno = EIO);
+}
+
+PUBLIC
+List* list_map(const char* path)
+{
+    if (!path) {
+        errno = EINVAL; return nullptr; }
+    if (!_host_little_endian()) {
+        errno = ENOTSUP; return nullptr; }   // payloads are used in place
+
+    size_t size = 0;
+    uint8_t* p = (uint8_t*) _file_map(path, &size);
+    if (!p) {
+        return nullptr; }
+
+    // check the header only, values are not looked at before being read
+    uint64_t n = 0, tags = 0, data = 0, heap = 0, heap_size = 0;
+    bool ok = (size >= FILE_HEADER) && !memcmp(p, FILE_MAGIC, 4) &&
+              (_get_le(p + 4, 2) >= 1) && (_get_le(p + 4, 2) <= FILE_VERSION);
+    if (ok) {
+      n = _get_le(p + 8, 8);
+      tags = _get_le(p + 16, 8);
+      data = _get_le(p + 24, 8);
+      heap = _get_le(p + 32, 8);
+      heap_size = _get_le(p + 40, 8);
+      // (none of the sums can wrap: each term is checked against "size" first)
+      ok = (tags >= FILE_HEADER) && (tags <= size) && (n <= size - tags) &&
+           (tags + n <= data) &&
+           (data % 8 == 0) && (data <= size) && (n <= (size - data) / 8) &&
+           (heap >= data + 8 * n) && (heap <= size) &&
+           (heap_size <= size - heap) &&
+           (heap_size == 0 || p[heap + heap_size - 1] == '\0');
+    }
+    if (!ok)
+    {   _file_unmap(p, size);
+        errno = EINVAL; return nullptr; }
+
+    List* l = list_create_flags(0, LIST_COMPACT);
+    l->map = p;
+    l->map_size = size;
+    l->tags = p + tags;
+    l->data = (Payload*)(p + data);
+    l->length = l->capacity = (size_t)n;
+    l->heap = (const char*)(p + heap);
+    l->heap_size = (size_t)heap_size;
+
+    return l;
+}
+
+ // "<path>.snap" values, then "<path>" changes, with strings of our own
+PUBLIC
+List* list_snapshot(List* list)
+{
+    if (!list || list->queue || list->heap) {
+        errno = EINVAL; return nullptr; }
+
+    List* snap = list_create_flags(list->timeout, LIST_COMPACT);
+    if (!_list_lock(list))
+    {   list_destroy(snap);
+        errno = EAGAIN; return nullptr; }
+
+    Frozen* f = nullptr;
+    if ((list->flags & LIST_COMPACT) && list->tags)
+    { // share the arrays: the list copies them before it overwrites our slots
+      if (!list->frozen) {
+        list->frozen = _frozen_create(list->tags - list->gap, list->data - list->gap); }
+      if ((f = list->frozen) && !list->map && !_frozen_hold(f, list->arena)) {
+        f = nullptr; }
+      if (f) {
+        atomic_fetch_add(&f->refs, 1);
+        if (!list->map && list->length > 0) {    // (a snapshot's are in already)
+          f->lo = (list->gap < f->lo) ? list->gap : f->lo;
+          f->hi = (list->gap + list->length > f->hi) ? list->gap + list->length : f->hi; }
+        snap->tags = list->tags;
+        snap->data = list->data;
+        snap->length = snap->capacity = list->length;
+      }
+    } else if (_store_reserve(snap, list->length))
+    { // or copy the values, in one walk
+      for (Value* c = list->first; c != nullptr; c = c->next) {
+        _store_put(snap, snap->length++, c); }
+      f = _frozen_create(snap->tags, snap->data);
+      if (f && !_frozen_hold(f, list->arena))
+      {   free(f);
+          f = nullptr; }
+    }
+    _list_unlock(list);
+
+    if (!f)
+    {   list_destroy(snap);
+        errno = ENOMEM; return nullptr; }
+    snap->frozen = f;
+    snap->map = f;
+
+    return snap;
+}
+
+PUBLIC
+List* list_open_journal(const char* path, unsigned int timeout, unsigned int flags,
+                        unsigned int sync_every)
+{
+    if (!path) {
+        errno = EINVAL; return nullptr; }
+
+    List* list = list_create_flags(timeout, flags);
+    Journal* j = (Journal*) calloc(1, sizeof(Journal));
+    char* snap = (char*) malloc(strlen(path) + 6);
+    if (!list || !j || !snap || !(j->path = strdup(path)))
+    {   if (j) { free(j->path); }
+        free(j); free(snap); list_destroy(list);
+        errno = ENOMEM; return nullptr; }
+    j->sync_every = sync_every;
+    sprintf(snap, "%s.snap", path);
+
+    errno_t e = EXIT_SUCCESS;
+    List* m = list_map(snap);
+    if (m) {
+      j->generation = _get_le((const uint8_t*)m->map + 48, 8);
+      for (size_t k = 0; !e && k < m->length; k++) {
+        Value v;
+        _store_get(m, k, &v);
+        v.idx = k;
+        if (v.t == T_STRING && v.s && !(v.s = _arena_strndup(list, v.s, strlen(v.s)))) {
+          e = ENOMEM; }
+        else {
+          e = _list_add_value(list, &v); }
+      }
+      list_destroy(m);
+    } else if (errno != ENOENT) {
+      e = errno;
+    }
+    free(snap);
+
+    // replay the records following that snapshot, up to a torn or bad one
+    uint8_t* buf = nullptr;
+    size_t size = 0, pos = JOURNAL_HEADER;
+    bool replayed = false;
+    FILE* f = e ? nullptr : fopen(path, "rb");
+    if (f) {
+      long end = (fseek(f, 0, SEEK_END) == 0) ? ftell(f) : -1;
+      rewind(f);
+      buf = (end > 0) ? (uint8_t*) malloc((size_t)end) : nullptr;
+      size = buf ? fread(buf, 1, (size_t)end, f) : 0;
+      fclose(f);
+      if (end < 0 || (end > 0 && size != (size_t)end)) {
+        e = EIO; }
+    }
+    if (!e && size >= JOURNAL_HEADER) {
+      uint64_t generation = _get_le(buf + 8, 8);
+      if (memcmp(buf, JOURNAL_MAGIC, 4) || _get_le(buf + 4, 2) == 0 ||
+          _get_le(buf + 4, 2) > JOURNAL_VERSION || generation > j->generation) {
+        e = EINVAL;                     // not ours, or its snapshot is lost
+      } else if (generation == j->generation) {
+        for (size_t at = pos; _journal_apply(list, buf, size, &at); pos = at) {
+          j->records++; }
+        replayed = true;
+      }                                 // else older: already in the snapshot
+    }
+    free(buf);
+
+    if (!e) {
+      list->journal = j;
+      if (replayed && pos < size) {
+        e = _journal_checkpoint(list);  // drops the torn tail
+      } else if (replayed) {
+        j->f = fopen(path, "ab");
+        e = j->f ? EXIT_SUCCESS : EIO;
+      } else {
+        j->f = fopen(path, "wb");
+        e = (j->f && _journal_header(j) && _file_sync(j->f)) ? EXIT_SUCCESS : EIO;
+      }
+    }
+    if (e)
+    {   if (!list->journal) {
+          free(j->path); free(j); }
+        list_destroy(list);
+        errno = e; return nullptr; }
+
+    return list;
+}
+
+PUBLIC
+errno_t list_sync(List* list)
+{
+    if (!list || !list->journal) {
+        return errno = EINVAL; }
+    if (!_list_lock(list)) {
+        return errno = EAGAIN; }
+
+    Journal* j = list->journal;
+    bool ok = j->f && _file_sync(j->f);
+    if (ok) {
+      j->pending = 0; }
+
+    _list_unlock(list);
+
+    return ok ? EXIT_SUCCESS : (errno = EIO);
+}
+
+PUBLIC
+errno_t list_checkpoint(List* list)
+{
+    if (!list || !list->journal) {
+        return errno = EINVAL; }
+    if (!_list_lock(list)) {
+        return errno = EAGAIN; }
+
+    errno_t e = _journal_checkpoint(list);
+
+    _list_unlock(list);
+
+    return e;
+}
+
+PUBLIC
+errno_t list_pop_front_int(List* list, int* i) {
+    LIST_POP_CHECK_IMPL(list, false, i); }
+
+PUBLIC
+errno_t list_pop_front_bool(List* list, bool* b) {
+    LIST_POP_CHECK_IMPL(list, false, b); }
+
+PUBLIC
+errno_t list_pop_front_float(List* list, double* f) {
+    LIST_POP_CHECK_IMPL(list, false, f); }
+
+PUBLIC
+errno_t list_pop_front_string(List* list, char** s) {
+    if (!list) {
+        return errno = EINVAL; }
+    return _list_pop_string(list, false, s); }
+
+PUBLIC
+errno_t list_pop_front_int64(List* list, int64_t* l) {
+    LIST_POP_CHECK_IMPL(list, false, l); }
+
+PUBLIC
+errno_t list_pop_front_Type(List* list, void* n) {
+    LIST_POP_CHECK_IMPL(list, false, n); }
+
+PUBLIC
+errno_t list_pop_back_int(List* list, int* i) {
+    LIST_POP_CHECK_IMPL(list, true, i); }
+
+PUBLIC
+errno_t list_pop_back_bool(List* list, bool* b) {
+    LIST_POP_CHECK_IMPL(list, true, b); }
+
+PUBLIC
+errno_t list_pop_back_float(List* list, double* f) {
+    LIST_POP_CHECK_IMPL(list, true, f); }
+
+PUBLIC
+errno_t list_pop_back_string(List* list, char** s) {
+    if (!list) {
+        return errno = EINVAL; }
+    return _list_pop_string(list, true, s); }
+
+PUBLIC
+errno_t list_pop_back_int64(List* list, int64_t* l) {
+    LIST_POP_CHECK_IMPL(list, true, l); }
+
+PUBLIC
+errno_t list_pop_back_Type(List* list, void* n) {
+    LIST_POP_CHECK_IMPL(list, true, n); }
 
 PUBLIC
 errno_t list_del(List* list, size_t idx) {
@@ -396,10 +5655,13 @@ errno_t list_del(List* list, size_t idx) {
 
 PUBLIC
 errno_t list_del_last(List* list) {
-    LIST_DEL_CHECK_IMPL(list, list->length-1); }
+    LIST_DEL_CHECK_IMPL(list, _list_length(list)-1); }
 
 PUBLIC
 errno_t list_del_first(List* list) {
+    if (list && list->queue)
+    {   Value v;
+        return _queue_pop(list, &v); }
     LIST_DEL_CHECK_IMPL(list, 0); }
 
 PUBLIC
@@ -410,18 +5672,72 @@ errno_t list_destroy(List* list)
     if (!_list_lock(list)) {
         return errno = EAGAIN; }
 
-    while (list->length > 0) {
+    while (list->first != nullptr) {
       Value* c = list->first;
       Value* n = c->next;
-      free(c);
+      _value_destroy(list, c);
       list->first = n;
       list->length--;
     }
+    if (list->frozen || (list->tags && !list->map)) {
+      _store_free(list->frozen, list->tags - list->gap, list->data - list->gap);
+    } else if (list->map) {
+      if (list->shared) {
+        _shared_detach(list); }
+      _file_unmap(list->map, list->map_size);
+    }
+    _index_free(list);
+    _arena_free(list);
+    _queue_free(list->queue);
+    _shards_free(list);
+
+    errno_t e = EXIT_SUCCESS;
+    if (list->journal) {
+      Journal* j = list->journal;
+      if (j->f && (!_file_sync(j->f) | (fclose(j->f) != 0))) {
+        e = errno = EIO; }
+      free(j->path);
+      free(j);
+    }
+    free(list->watches);
+    cnd_destroy(&list->changed);
     mtx_destroy(&list->locked);
     free(list);
     list = nullptr;
 
-    return EXIT_SUCCESS;
+    return e;
+}
+
+PUBLIC
+errno_t list_write(List* list, int fd, unsigned int format)
+{
+    if (!list || fd < 0 || format > LIST_BINARY) {
+        return errno = EINVAL; }
+
+    Writer w = { .fd = fd, .buf = (char*) malloc(WRITE_BUFFER) };
+    if (!w.buf) {
+        return errno = ENOMEM; }
+
+    // the list is only locked while snapshotting (queues and shared lists
+    // have no snapshots: locked throughout)
+    List* src = (list->queue || list->heap) ? list : list_snapshot(list);
+    if (!src)
+    {   free(w.buf);
+        return errno; }
+    if (!_list_lock(src))
+    {   if (src != list) { list_destroy(src); }
+        free(w.buf);
+        return errno = EAGAIN; }
+
+    _write_list(&w, src, format);
+    _writer_flush(&w);
+
+    _list_unlock(src);
+    if (src != list) {
+      list_destroy(src); }
+    free(w.buf);
+
+    return w.e ? (errno = w.e) : EXIT_SUCCESS;
 }
 
 PUBLIC
@@ -429,37 +5745,238 @@ errno_t list_dump(List* list)
 {
     if (!list) {
         return errno = EINVAL; }
+
+    fflush(stdout);     // what "printf()" buffered goes first
+    return list_write(list, _stdout_fd(), LIST_TEXT);
+}
+
+PUBLIC
+size_t list_length(List* list)
+{
+    if (list && list->queue) {
+        return _queue_length(list->queue); }
+    return list ? _list_length(list) : 0;
+}
+
+PUBLIC
+errno_t list_stats(List* list, ListStats* stats)
+{
+    if (!list || !stats) {
+        return errno = EINVAL; }
     if (!_list_lock(list)) {
         return errno = EAGAIN; }
 
-    printf("List length: %zd\n-----------\n%s", list->length, (list->length == 0)?"<empty>\n":"");
+    stats->locks = list->locks;
+    stats->contended = list->contended;
+    stats->timeouts = atomic_load_explicit(&list->timeouts, memory_order_relaxed);
+    stats->wait_ms = list->wait_ns / 1e6;
+
+    // what the values take, whatever the storage (mapped ones excepted)
+    size_t node = sizeof(Value) + ((list->flags & LIST_STRCACHE) ? sizeof(char*) : 0);
+    size_t bytes = (list->flags & LIST_COMPACT) ? 0 : list->length * node;
+    if (!list->map) {
+      bytes += (list->gap + list->capacity) * (1 + sizeof(Payload)); }
+    if (list->index.heads) {
+      bytes += (list->index.mask + 1) * sizeof(size_t) +
+               list->index.capacity * sizeof(IndexEntry); }
+    if (list->queue) {
+      bytes += (list->queue->mask + 1) * sizeof(QueueCell); }
+    for (Arena* a = list->arena; a != nullptr; a = a->next) {
+      bytes += sizeof(Arena) + a->size; }
+    stats->memory = bytes;
+
+    _list_unlock(list);
+
+    return EXIT_SUCCESS;
+}
+
+PUBLIC
+errno_t list_wait_length(List* list, size_t min_len, unsigned int timeout)
+{
+    if (!list) {
+        return errno = EINVAL; }
 
-    Value *c = list->first;
-    for (typeof(list->length) i = 0; i < list->length; i++) { // C23
-      { 
-        printf("[%zd]: ", c->idx);
-        switch (c->t) {
-          case T_INTEGER: printf("(INTEGER)\t"); break;
-          case T_BOOLEAN: printf("(BOOLEAN)\t"); break;
-          case T_FLOAT  : printf("(FLOAT)\t");   break;
-          case T_STRING : printf("(STRING)\t");  break;
-          default: fprintf(stderr, "(ERR: Undefined)\t");
-        }
-        _value_dump(c);
-        putchar('\n');
+    struct timespec ts;
+    _deadline(&ts, timeout);
+    bool ok;
+
+    if (list->queue)
+    { Queue* q = list->queue;
+      mtx_lock(&q->lock);
+      atomic_fetch_add(&q->sleepers, 1);
+      atomic_thread_fence(memory_order_seq_cst);
+      while (!(ok = (_queue_length(q) >= min_len)) &&
+             cnd_timedwait(&q->changed, &q->lock, &ts) == thrd_success) {}
+      ok = ok || (_queue_length(q) >= min_len);
+      atomic_fetch_sub(&q->sleepers, 1);
+      mtx_unlock(&q->lock);
+    }
+    else if (list->shared)
+    { // other processes cannot wake us
+      ok = (_list_length(list) >= min_len);
+      for (size_t us = 0; !ok && us < timeout; us += 1000) {
+        _shared_sleep();
+        ok = (_list_length(list) >= min_len); }
+    }
+    else
+    { // the wait would only release one of our locks, and nobody could change it
+      if (_list_locked_here(list)) {
+          return errno = EDEADLK; }
+      if (!_list_lock(list)) {
+          return errno = EAGAIN; }
+      atomic_fetch_add(&list->waiters, 1);
+      atomic_thread_fence(memory_order_seq_cst);
+      for (;;) {
+        if (list->shards) {
+          _shards_merge(list); }     // (not re-locked through "_list_lock()")
+        if ((ok = (list->length >= min_len))) {
+          break; }
+        // others get the lock meanwhile: ours again after
+        list->depth = 0;
+        atomic_store_explicit(&list->owner, 0, memory_order_relaxed);
+        bool woken = (cnd_timedwait(&list->changed, &list->locked, &ts) == thrd_success);
+        list->depth = 1;
+        atomic_store_explicit(&list->owner, (uintptr_t)&_thread_id, memory_order_relaxed);
+        if (!woken) {
+          break; }
       }
-      c = c->next;
+      if (!ok && list->shards)
+      {   _shards_merge(list);
+          ok = (list->length >= min_len); }
+      atomic_fetch_sub(&list->waiters, 1);
+      _list_unlock(list);
     }
-    putchar('\n');
 
-    mtx_unlock(&list->locked);
+    return ok ? EXIT_SUCCESS : (errno = EAGAIN);
+}
 
-    return EXIT_SUCCESS;
+PUBLIC
+errno_t list_watch(List* list, ListWatch fn, void* data)
+{
+    if (!list || !fn || list->queue || list->shared) {
+        return errno = EINVAL; }
+    if (!_list_lock(list)) {
+        return errno = EAGAIN; }
+
+    Watch* w = (Watch*) realloc(list->watches, (list->watch_count + 1) * sizeof(Watch));
+    if (w) {
+      list->watches = w;
+      list->watches[list->watch_count++] = (Watch){ fn, data }; }
+    _list_unlock(list);
+
+    return w ? EXIT_SUCCESS : (errno = ENOMEM);
 }
 
 PUBLIC
-size_t list_length(List* list)
+errno_t list_unwatch(List* list, ListWatch fn, void* data)
+{
+    if (!list || !fn) {
+        return errno = EINVAL; }
+    if (!_list_lock(list)) {
+        return errno = EAGAIN; }
+
+    errno_t e = ENOENT;
+    for (size_t k = 0; k < list->watch_count; k++) {
+      if (list->watches[k].fn == fn && list->watches[k].data == data)
+      { memmove(&list->watches[k], &list->watches[k + 1],
+                (list->watch_count - k - 1) * sizeof(Watch));
+        list->watch_count--;
+        e = EXIT_SUCCESS;
+        break; }
+    }
+    _list_unlock(list);
+
+    return errno = e;
+}
+
+PUBLIC
+ListIter* list_iter_begin(List* list)
+{
+    if (!list) {
+        errno = EINVAL; return nullptr; }
+    if (!_list_lock(list)) {
+        errno = EAGAIN; return nullptr; }
+
+    auto it = (ListIter*) calloc(1, sizeof(ListIter)); // C23
+    if (!it)
+    {   _list_unlock(list);
+        errno = ENOMEM; return nullptr; }
+    it->list = list;
+    it->next = 0;
+    it->cur = nullptr;
+
+    return it;
+}
+
+PUBLIC
+bool list_iter_next(ListIter* it)
+{
+    if (!it) {
+        return false; }
+
+    if (it->next >= it->list->length) {
+      it->cur = nullptr;
+      return false;
+    }
+
+    it->cur = (it->next == 0) ? _list_seek(it->list, &it->at, 0)
+                              : _list_step(it->list, &it->at);
+    it->next++;
+
+    return true;
+}
+
+PUBLIC
+size_t list_iter_index(ListIter* it)
+{
+    return it ? it->at.idx : 0;
+}
+
+PUBLIC
+errno_t list_iter_get_int(ListIter* it, int* i) {
+    LIST_ITER_CHECK_IMPL(it, i); }
+
+PUBLIC
+errno_t list_iter_get_bool(ListIter* it, bool* b) {
+    LIST_ITER_CHECK_IMPL(it, b); }
+
+PUBLIC
+errno_t list_iter_get_float(ListIter* it, double* f) {
+    LIST_ITER_CHECK_IMPL(it, f); }
+
+PUBLIC
+errno_t list_iter_get_string(ListIter* it, char** s) {
+    LIST_ITER_CHECK_IMPL(it, s); }
+
+PUBLIC
+errno_t list_iter_get_int64(ListIter* it, int64_t* l) {
+    LIST_ITER_CHECK_IMPL(it, l); }
+
+PUBLIC
+errno_t list_iter_get_blob(ListIter* it, ListBlob* b) {
+    LIST_ITER_CHECK_IMPL(it, b); }
+
+PUBLIC
+errno_t list_iter_get_Type(ListIter* it, void* n) {
+    LIST_ITER_CHECK_IMPL(it, n); }
+
+PUBLIC
+errno_t list_iter_get_string_buf(ListIter* it, char* buf, size_t len)
 {
-    return list ? list->length : 0;
+    if (!it || !it->cur || !buf) {
+        return errno = EINVAL; }
+
+    return errno = _value_get_string_buf(it->list, it->cur, buf, len);
 }
 
+PUBLIC
+errno_t list_iter_end(ListIter* it)
+{
+    if (!it) {
+        return errno = EINVAL; }
+
+    _list_unlock(it->list);
+    free(it);
+
+    return EXIT_SUCCESS;
+}
@@ -14,7 +14,8 @@ for FILE in \
     lib$NAME.so \
     lib$NAME.so.? \
     $NAME-static \
-    $NAME-shared; do
+    $NAME-shared \
+    $NAME-bench; do
     rm -f ${FILE}
 done
 
@@ -23,7 +24,8 @@ for FILE in \
     lib$NAME.dll.a \
     lib$NAME.dll \
     $NAME-static.exe \
-    $NAME-shared.exe; do
+    $NAME-shared.exe \
+    $NAME-bench.exe; do
     rm -f ${FILE}
 done
 
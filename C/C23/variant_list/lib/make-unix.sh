@@ -30,6 +30,9 @@ ${CC} -std=c23 -Wall -static -o $NAME-static $NAME.c -L. -l$NAME -lm ${LDFLAGS}
 echo "Make-ing shared executable..."
 ${CC} -std=c23 -Wall -o $NAME-shared $NAME.c -L. -l$NAME
 
+echo "Make-ing benchmark executable..."
+${CC} -std=c23 -Wall -O2 -o $NAME-bench ${NAME}_bench.c lib$NAME.a -lm ${LDFLAGS}
+
 
 echo "Cleaning intermediate files..."
 rm -f lib$NAME.o
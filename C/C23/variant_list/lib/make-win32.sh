@@ -28,6 +28,9 @@ ${CC} -std=c23 -Wall -static ${CPPFLAGS} ${CFLAGS} -o $NAME-static.exe $NAME.c -
 echo "Make-ing shared executable..."
 ${CC} -std=c23 -Wall ${CPPFLAGS} ${CFLAGS} -o $NAME-shared.exe $NAME.c -L. -l$NAME
 
+echo "Make-ing benchmark executable..."
+${CC} -std=c23 -Wall -O2 ${CPPFLAGS} ${CFLAGS} -o $NAME-bench.exe ${NAME}_bench.c lib$NAME.a -lm ${LDFLAGS}
+
 
 echo "Cleaning intermediate files..."
 rm -f lib$NAME.o